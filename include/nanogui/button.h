@@ -41,25 +41,25 @@ public:
     Button(Widget *parent, const std::string &caption = "Untitled", int icon = 0);
 
     const std::string &caption() const { return mCaption; }
-    void setCaption(const std::string &caption) { mCaption = caption; }
+    void setCaption(const std::string &caption) { mCaption = caption; invalidatePreferredSize(); markDirty(); }
 
     const Color &backgroundColor() const { return mBackgroundColor; }
-    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; }
+    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; markDirty(); }
 
     const Color &textColor() const { return mTextColor; }
-    void setTextColor(const Color &textColor) { mTextColor = textColor; }
+    void setTextColor(const Color &textColor) { mTextColor = textColor; markDirty(); }
 
     int icon() const { return mIcon; }
-    void setIcon(int icon) { mIcon = icon; }
+    void setIcon(int icon) { mIcon = icon; invalidatePreferredSize(); markDirty(); }
 
     int flags() const { return mFlags; }
     void setFlags(int buttonFlags) { mFlags = buttonFlags; }
 
     IconPosition iconPosition() const { return mIconPosition; }
-    void setIconPosition(IconPosition iconPosition) { mIconPosition = iconPosition; }
+    void setIconPosition(IconPosition iconPosition) { mIconPosition = iconPosition; markDirty(); }
 
     bool pushed() const { return mPushed; }
-    void setPushed(bool pushed) { mPushed = pushed; }
+    void setPushed(bool pushed) { mPushed = pushed; markDirty(); }
 
     /// Set the push callback (for any type of button)
     std::function<void()> callback() const { return mCallback; }
@@ -360,26 +360,36 @@ class ColorPicker;
 class ComboBox;
 class GLFramebuffer;
 class GLShader;
+class GraphDataSource;
 class GridLayout;
 class GroupLayout;
 class ImagePanel;
 class ImageView;
 class Label;
 class Layout;
+class ListView;
+class MappedGraphDataSource;
 class MessageDialog;
 class Object;
+class PlotCanvas;
 class Popup;
 class PopupButton;
 class ProgressBar;
 class Screen;
 class Serializer;
 class Slider;
+class SparklineGrid;
+class SpatialGrid;
 class StackedWidget;
+class StreamingTexture;
 class TabHeader;
 class TabWidget;
 class TextBox;
+class TextMetrics;
 class GLCanvas;
 class Theme;
+class TileCache;
+class TiledImageSource;
 class ToolButton;
 class VScrollPanel;
 class Widget;
@@ -408,9 +418,10 @@ extern NANOGUI_EXPORT void shutdown();
  *
  * \param refresh
  *     NanoGUI issues a redraw call whenever an keyboard/mouse/.. event is
- *     received. In the absence of any external events, it enforces a redraw
- *     once every ``refresh`` milliseconds. To disable the refresh timer,
- *     specify a negative value here.
+ *     received. In the absence of any external events, it wakes up once
+ *     every ``refresh`` milliseconds and redraws those screens that contain
+ *     widgets marked as dirty (see \ref Widget::markDirty()). To disable
+ *     the refresh timer, specify a negative value here.
  *
  * \param detach
  *     This pararameter only exists in the Python bindings. When the active
@@ -15,6 +15,9 @@
 #include <nanogui/opengl.h>
 #include <Eigen/Geometry>
 #include <map>
+#include <memory>
+#include <type_traits>
+#include <vector>
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 namespace half_float { class half; }
@@ -41,6 +44,13 @@ template <> struct type_traits<double> { enum { type = GL_DOUBLE, integral = 0 }
 template <> struct type_traits<float> { enum { type = GL_FLOAT, integral = 0 }; };
 template <> struct type_traits<half_float::half> { enum { type = GL_HALF_FLOAT, integral = 0 }; };
 template <typename T> struct serialization_helper;
+
+/* Number and type of the components of a vertex struct member */
+template <typename T> struct vertex_member_traits { typedef T Scalar; enum { dim = 1 }; };
+template <typename T, size_t N> struct vertex_member_traits<T[N]> { typedef T Scalar; enum { dim = (int) N }; };
+template <typename T, int Rows, int Options, int MaxRows>
+struct vertex_member_traits<Eigen::Matrix<T, Rows, 1, Options, MaxRows, 1>> { typedef T Scalar; enum { dim = Rows }; };
+template <> struct vertex_member_traits<Color> : vertex_member_traits<Eigen::Vector4f> { };
 NAMESPACE_END(detail)
 
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -49,6 +59,162 @@ using Eigen::Quaternionf;
 
 class GLUniformBuffer;
 
+/**
+ * \struct UniformHandle glutil.h nanogui/glutil.h
+ *
+ * \brief Location of a uniform variable, obtained once via \ref
+ * GLShader::uniformHandle() and then passed to \ref GLShader::setUniform()
+ * without any name lookup.
+ */
+struct UniformHandle {
+    explicit UniformHandle(GLint location = -1) : location(location) { }
+
+    /// Check whether the uniform exists in the program
+    bool valid() const { return location >= 0; }
+
+    GLint location;
+};
+
+/**
+ * \struct VertexAttribute glutil.h nanogui/glutil.h
+ *
+ * \brief Name, type and byte offset of one attribute within an interleaved
+ * vertex (see \ref VertexLayout).
+ */
+struct VertexAttribute {
+    std::string name;
+    GLint dim;
+    GLuint glType;
+    bool integral;
+    size_t offset;
+
+    bool operator==(const VertexAttribute &other) const {
+        return name == other.name && dim == other.dim && glType == other.glType &&
+               integral == other.integral && offset == other.offset;
+    }
+};
+
+/**
+ * \class VertexLayout glutil.h nanogui/glutil.h
+ *
+ * \brief Description of a vertex struct whose members are uploaded as
+ * interleaved attributes of a single buffer object.
+ *
+ * The number and type of the components of each attribute are deduced from
+ * the member type (a scalar, a fixed-size array, a fixed-size Eigen column
+ * vector or a \ref Color), and the offset from the member pointer:
+ *
+ * \code
+ * struct Vertex { Vector3f position, normal; Vector2f uv; Color color; };
+ *
+ * VertexLayout<Vertex> layout;
+ * layout.add("position", &Vertex::position)
+ *       .add("normal", &Vertex::normal)
+ *       .add("uv", &Vertex::uv)
+ *       .add("color", &Vertex::color);
+ * shader.uploadVertices("vertices", layout, vertices);
+ * \endcode
+ *
+ * Vectorizable Eigen members (e.g. \c Vector4f or \ref Color) require
+ * storing the vertices with \c Eigen::aligned_allocator.
+ */
+template <typename Vertex> class VertexLayout {
+public:
+    /// Describe the member \c member as the vertex attribute \c name
+    template <typename T> VertexLayout &add(const std::string &name, T Vertex::*member) {
+        typedef detail::vertex_member_traits<T> traits;
+        typedef typename traits::Scalar Scalar;
+        static_assert(traits::dim >= 1 && traits::dim <= 4,
+                      "VertexLayout: attributes must have between 1 and 4 components!");
+        static_assert(sizeof(T) == traits::dim * sizeof(Scalar),
+                      "VertexLayout: the components of an attribute must be tightly packed!");
+
+        mAttributes.push_back(VertexAttribute {
+            name, (GLint) traits::dim,
+            (GLuint) detail::type_traits<Scalar>::type,
+            (bool) detail::type_traits<Scalar>::integral,
+            offset(member) });
+        return *this;
+    }
+
+    /// Return the attributes in the order of their registration
+    const std::vector<VertexAttribute> &attributes() const { return mAttributes; }
+
+    /// Return the distance between consecutive vertices in bytes
+    static constexpr size_t stride() { return sizeof(Vertex); }
+
+private:
+    template <typename T> static size_t offset(T Vertex::*member) {
+        typename std::aligned_storage<sizeof(Vertex), alignof(Vertex)>::type storage;
+        const Vertex *vertex = reinterpret_cast<const Vertex *>(&storage);
+        return (size_t) (reinterpret_cast<const char *>(&(vertex->*member)) -
+                         reinterpret_cast<const char *>(vertex));
+    }
+
+    std::vector<VertexAttribute> mAttributes;
+};
+
+/**
+ * \brief Copy the columns of an Eigen matrix (e.g. the input of \ref
+ * GLShader::uploadAttrib()) into a member of consecutive vertices
+ *
+ * An empty vertex array is resized to the number of columns, otherwise the
+ * sizes must match.
+ */
+template <typename Vertex, typename Alloc, typename T, typename Matrix>
+void interleave(std::vector<Vertex, Alloc> &vertices, T Vertex::*member, const Matrix &M) {
+    typedef detail::vertex_member_traits<T> traits;
+    typedef typename traits::Scalar Scalar;
+
+    if (vertices.empty())
+        vertices.resize((size_t) M.cols());
+    if ((size_t) M.cols() != vertices.size() || (int) M.rows() != (int) traits::dim)
+        throw std::runtime_error("interleave(): size mismatch!");
+
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        Scalar *target = reinterpret_cast<Scalar *>(&(vertices[i].*member));
+        for (int j = 0; j < (int) traits::dim; ++j)
+            target[j] = (Scalar) M(j, (typename Matrix::Index) i);
+    }
+}
+
+/**
+ * \struct DrawArrayCommand glutil.h nanogui/glutil.h
+ *
+ * \brief Arguments of one non-indexed draw call within a batch submitted by
+ * \ref GLShader::multiDrawArray(). The layout matches the indirect draw
+ * command of OpenGL, so that batches are uploaded as they are.
+ */
+struct DrawArrayCommand {
+    /// Number of vertices
+    uint32_t count;
+    /// Number of instances
+    uint32_t instanceCount;
+    /// Index of the first vertex
+    uint32_t first;
+    /// Index of the first instance for attributes with a divisor
+    uint32_t baseInstance;
+};
+
+/**
+ * \struct DrawIndexedCommand glutil.h nanogui/glutil.h
+ *
+ * \brief Arguments of one indexed draw call within a batch submitted by
+ * \ref GLShader::multiDrawIndexed() (see \ref DrawArrayCommand).
+ */
+struct DrawIndexedCommand {
+    /// Number of indices
+    uint32_t count;
+    /// Number of instances
+    uint32_t instanceCount;
+    /// Position of the first index in the index buffer
+    uint32_t firstIndex;
+    /// Value added to each index
+    int32_t baseVertex;
+    /// Index of the first instance for attributes with a divisor
+    uint32_t baseInstance;
+};
+
 //  ----------------------------------------------------
 
 /**
@@ -66,7 +232,7 @@ public:
     /// Create an unitialized OpenGL shader
     GLShader()
         : mVertexShader(0), mFragmentShader(0), mGeometryShader(0),
-          mProgramShader(0), mVertexArrayObject(0) { }
+          mProgramShader(0), mVertexArrayObject(0), mIndirectBuffer(0) { }
 
     /**
      * \brief Initialize the shader using the specified source strings.
@@ -110,6 +276,74 @@ public:
                        const std::string &fragment_fname,
                        const std::string &geometry_fname = "");
 
+    /**
+     * \brief Initialize the shader using a program shared with all other
+     * shaders initialized from the same name, sources and definitions.
+     *
+     * Shared programs are kept in a reference-counted registry (one per
+     * OpenGL context), so that they are only compiled and linked once.
+     * Vertex array state and the buffers created by \ref uploadAttrib()
+     * remain specific to this instance. Since uniform values are stored in
+     * the program, they must be set before each draw call.
+     *
+     * The parameters are the same as for \ref init().
+     */
+    bool initShared(const std::string &name, const std::string &vertex_str,
+                    const std::string &fragment_str,
+                    const std::string &geometry_str = "");
+
+    /// Check whether the program is shared through the registry (see \ref initShared())
+    bool shared() const { return !mSharedKey.empty(); }
+
+    /// Return the number of programs in the shared program registry
+    static size_t sharedProgramCount();
+
+    /// Statistics of the program binary cache (see \ref setProgramCacheDirectory())
+    struct ProgramCacheStatistics {
+        /// Number of programs loaded from the cache
+        size_t hits = 0;
+        /// Number of programs compiled because no cached binary existed
+        size_t misses = 0;
+        /// Number of cached binaries that were rejected by the driver or unreadable
+        size_t rejected = 0;
+        /// Number of binaries written to the cache
+        size_t stored = 0;
+    };
+
+    /**
+     * \brief Cache linked programs as binaries in the given directory (or
+     * disable the cache if it is empty, which is the default)
+     *
+     * Binaries are keyed by the shader sources, the preprocessor
+     * definitions and the vendor, renderer and version strings of the
+     * driver, so that later calls of \ref init() and \ref initShared() skip
+     * compiling and linking. Binaries that the driver rejects (e.g. after an
+     * update it did not report in its version string) are discarded and
+     * replaced transparently. Requires OpenGL 4.1 or ARB_get_program_binary;
+     * otherwise the cache is not used.
+     */
+    static void setProgramCacheDirectory(const std::string &directory);
+
+    /// Return the directory of the program binary cache (empty if disabled)
+    static const std::string &programCacheDirectory();
+
+    /**
+     * \brief Log every hit and miss of the program binary cache to \c std::cerr
+     *
+     * Rejected binaries are always logged. Use \ref programCacheStatistics()
+     * to obtain the totals without logging.
+     */
+    static void setProgramCacheVerbose(bool verbose);
+
+    /// Return whether hits and misses of the program binary cache are logged
+    static bool programCacheVerbose();
+
+    /// Return the per-user cache directory of the platform, e.g. <tt>~/.cache/nanogui/programs</tt> on Linux
+    static std::string defaultProgramCacheDirectory();
+
+    /// Return the number of hits, misses, rejected and stored binaries of the program cache
+    static const ProgramCacheStatistics &programCacheStatistics();
+
     /// Return the name of the shader
     const std::string &name() const { return mName; }
 
@@ -128,6 +362,18 @@ public:
     /// Return the handle of a uniform attribute (-1 if it does not exist)
     GLint uniform(const std::string &name, bool warn = true) const;
 
+    /**
+     * \brief Return the handle of a uniform attribute for the overloads of
+     * \ref setUniform() that skip the name lookup in hot loops
+     *
+     * The locations of all active uniforms, uniform blocks and attributes
+     * are queried once after linking, so that the name-based functions
+     * only search a table instead of asking the driver.
+     */
+    UniformHandle uniformHandle(const std::string &name, bool warn = true) const {
+        return UniformHandle(uniform(name, warn));
+    }
+
     /// Upload an Eigen matrix as a vertex buffer object (refreshing it as needed)
     template <typename Matrix> void uploadAttrib(const std::string &name, const Matrix &M, int version = -1) {
         uint32_t compSize = sizeof(typename Matrix::Scalar);
@@ -138,6 +384,58 @@ public:
                      glType, integral, M.data(), version);
     }
 
+    /**
+     * \brief Overwrite part of a vertex buffer object created by \ref uploadAttrib(),
+     * starting at the given column (i.e. vertex) index
+     *
+     * Only the modified range is transferred, and the buffer keeps its size.
+     */
+    template <typename Matrix> void updateAttrib(const std::string &name, const Matrix &M, size_t offset) {
+        updateAttrib(name, offset * (size_t) M.rows(), (size_t) M.size(),
+                     sizeof(typename Matrix::Scalar), M.data());
+    }
+
+    /**
+     * \brief Upload an Eigen matrix that changes every frame through a ring of
+     * \c segments buffer regions
+     *
+     * Each call writes into the next region, so the CPU never waits for draw
+     * calls still reading one of the previous frames. A fence is inserted
+     * when moving on from a region and waited upon before the region is
+     * written again. The buffer is mapped persistently if the context
+     * supports it (see \ref persistentMappingSupported()), and otherwise
+     * mapped without synchronization for each write.
+     */
+    template <typename Matrix> void streamAttrib(const std::string &name, const Matrix &M, int segments = 3) {
+        uint32_t compSize = sizeof(typename Matrix::Scalar);
+        GLuint glType = (GLuint) detail::type_traits<typename Matrix::Scalar>::type;
+        bool integral = (bool) detail::type_traits<typename Matrix::Scalar>::integral;
+
+        streamAttrib(name, (size_t) M.size(), (int) M.rows(), compSize,
+                     glType, integral, M.data(), segments);
+    }
+
+    /**
+     * \brief Upload interleaved vertices into one vertex buffer object
+     * registered as \c name, and point all attributes of the layout into it
+     *
+     * Attributes of the layout that the program does not use are skipped.
+     * Sharing the buffer via \ref shareAttrib() sets up all attributes at
+     * once.
+     */
+    template <typename Vertex>
+    void uploadVertices(const std::string &name, const VertexLayout<Vertex> &layout,
+                        const Vertex *vertices, size_t count, int version = -1) {
+        uploadVertices(name, layout.attributes(), layout.stride(), count, vertices, version);
+    }
+
+    /// Upload interleaved vertices from a vector (see above)
+    template <typename Vertex, typename Alloc>
+    void uploadVertices(const std::string &name, const VertexLayout<Vertex> &layout,
+                        const std::vector<Vertex, Alloc> &vertices, int version = -1) {
+        uploadVertices(name, layout, vertices.data(), vertices.size(), version);
+    }
+
     /// Download a vertex buffer object into an Eigen matrix
     template <typename Matrix> void downloadAttrib(const std::string &name, Matrix &M) {
         uint32_t compSize = sizeof(typename Matrix::Scalar);
@@ -158,6 +456,23 @@ public:
         uploadAttrib("indices", M, version);
     }
 
+    /**
+     * \brief Use a static vertex (or index) buffer that is shared by all users
+     * of a shared program (see \ref initShared())
+     *
+     * Only the first call for a given name uploads the data, later calls
+     * merely bind the existing buffer. The buffer lives as long as the
+     * program.
+     */
+    template <typename Matrix> void uploadSharedAttrib(const std::string &name, const Matrix &M) {
+        uint32_t compSize = sizeof(typename Matrix::Scalar);
+        GLuint glType = (GLuint) detail::type_traits<typename Matrix::Scalar>::type;
+        bool integral = (bool) detail::type_traits<typename Matrix::Scalar>::integral;
+
+        uploadSharedAttrib(name, (uint32_t) M.size(), (int) M.rows(), compSize,
+                           glType, integral, M.data());
+    }
+
     /// Invalidate the version numbers associated with attribute data
     void invalidateAttribs();
 
@@ -168,7 +483,7 @@ public:
     bool hasAttrib(const std::string &name) const {
         auto it = mBufferObjects.find(name);
         if (it == mBufferObjects.end())
-            return false;
+            return mStreamingBuffers.find(name) != mStreamingBuffers.end();
         return true;
     }
 
@@ -190,64 +505,137 @@ public:
             it->second.version = -1;
     }
 
+    /**
+     * \brief Advance an attribute once every \c divisor instances during
+     * instanced draw calls instead of once per vertex (0)
+     *
+     * For interleaved vertices (see \ref uploadVertices()), the divisor
+     * applies to all attributes of the buffer.
+     */
+    void setAttribDivisor(const std::string &name, uint32_t divisor);
+
     /// Draw a sequence of primitives
     void drawArray(int type, uint32_t offset, uint32_t count);
 
     /// Draw a sequence of primitives using a previously uploaded index buffer
     void drawIndexed(int type, uint32_t offset, uint32_t count);
 
+    /// Draw \c instances copies of a sequence of primitives
+    void drawArrayInstanced(int type, uint32_t offset, uint32_t count, uint32_t instances);
+
+    /// Draw \c instances copies of a sequence of primitives using a previously uploaded index buffer
+    void drawIndexedInstanced(int type, uint32_t offset, uint32_t count, uint32_t instances);
+
+    /**
+     * \brief Submit a batch of draw calls
+     *
+     * The batch is drawn by a single indirect draw call if the context
+     * supports it (see \ref multiDrawIndirectSupported()). Otherwise,
+     * batches of single instances are drawn with \c glMultiDrawArrays(),
+     * and others with one instanced draw call per command, which requires
+     * all \c baseInstance values to be zero.
+     *
+     * Unlike \ref drawArray(), the offsets and counts are given in vertices.
+     */
+    void multiDrawArray(int type, const DrawArrayCommand *commands, size_t count);
+
+    /// Submit a batch of draw calls (see above)
+    void multiDrawArray(int type, const std::vector<DrawArrayCommand> &commands) {
+        multiDrawArray(type, commands.data(), commands.size());
+    }
+
+    /**
+     * \brief Submit a batch of draw calls using a previously uploaded index buffer
+     *
+     * The fallbacks match those of \ref multiDrawArray(). Unlike \ref
+     * drawIndexed(), the offsets and counts are given in indices.
+     */
+    void multiDrawIndexed(int type, const DrawIndexedCommand *commands, size_t count);
+
+    /// Submit a batch of draw calls using a previously uploaded index buffer (see above)
+    void multiDrawIndexed(int type, const std::vector<DrawIndexedCommand> &commands) {
+        multiDrawIndexed(type, commands.data(), commands.size());
+    }
+
+    /// Check whether batches of draw calls are submitted at once in the current context (OpenGL 4.3 or ARB_multi_draw_indirect)
+    static bool multiDrawIndirectSupported();
+
     /// Initialize a uniform parameter with a 4x4 matrix (float)
     template <typename T>
     void setUniform(const std::string &name, const Eigen::Matrix<T, 4, 4> &mat, bool warn = true) {
-        glUniformMatrix4fv(uniform(name, warn), 1, GL_FALSE, mat.template cast<float>().data());
+        setUniform(uniformHandle(name, warn), mat);
     }
 
     /// Initialize a uniform parameter with an integer value
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 1, int>::type = 0>
     void setUniform(const std::string &name, T value, bool warn = true) {
-        glUniform1i(uniform(name, warn), (int) value);
+        setUniform(uniformHandle(name, warn), value);
     }
 
     /// Initialize a uniform parameter with a floating point value
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 0, int>::type = 0>
     void setUniform(const std::string &name, T value, bool warn = true) {
-        glUniform1f(uniform(name, warn), (float) value);
+        setUniform(uniformHandle(name, warn), value);
+    }
+
+    /// Initialize a uniform parameter with a 2D, 3D or 4D vector
+    template <typename T, int Size>
+    void setUniform(const std::string &name, const Eigen::Matrix<T, Size, 1> &v, bool warn = true) {
+        setUniform(uniformHandle(name, warn), v);
+    }
+
+    /// Initialize a uniform parameter with a 4x4 matrix (float)
+    template <typename T>
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 4, 4> &mat) {
+        glUniformMatrix4fv(handle.location, 1, GL_FALSE, mat.template cast<float>().data());
+    }
+
+    /// Initialize a uniform parameter with an integer value
+    template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 1, int>::type = 0>
+    void setUniform(UniformHandle handle, T value) {
+        glUniform1i(handle.location, (int) value);
+    }
+
+    /// Initialize a uniform parameter with a floating point value
+    template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 0, int>::type = 0>
+    void setUniform(UniformHandle handle, T value) {
+        glUniform1f(handle.location, (float) value);
     }
 
     /// Initialize a uniform parameter with a 2D vector (int)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 1, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 2, 1>  &v, bool warn = true) {
-        glUniform2i(uniform(name, warn), (int) v.x(), (int) v.y());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 2, 1>  &v) {
+        glUniform2i(handle.location, (int) v.x(), (int) v.y());
     }
 
     /// Initialize a uniform parameter with a 2D vector (float)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 0, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 2, 1>  &v, bool warn = true) {
-        glUniform2f(uniform(name, warn), (float) v.x(), (float) v.y());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 2, 1>  &v) {
+        glUniform2f(handle.location, (float) v.x(), (float) v.y());
     }
 
     /// Initialize a uniform parameter with a 3D vector (int)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 1, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 3, 1>  &v, bool warn = true) {
-        glUniform3i(uniform(name, warn), (int) v.x(), (int) v.y(), (int) v.z());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 3, 1>  &v) {
+        glUniform3i(handle.location, (int) v.x(), (int) v.y(), (int) v.z());
     }
 
     /// Initialize a uniform parameter with a 3D vector (float)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 0, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 3, 1>  &v, bool warn = true) {
-        glUniform3f(uniform(name, warn), (float) v.x(), (float) v.y(), (float) v.z());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 3, 1>  &v) {
+        glUniform3f(handle.location, (float) v.x(), (float) v.y(), (float) v.z());
     }
 
     /// Initialize a uniform parameter with a 4D vector (int)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 1, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 4, 1>  &v, bool warn = true) {
-        glUniform4i(uniform(name, warn), (int) v.x(), (int) v.y(), (int) v.z(), (int) v.w());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 4, 1>  &v) {
+        glUniform4i(handle.location, (int) v.x(), (int) v.y(), (int) v.z(), (int) v.w());
     }
 
     /// Initialize a uniform parameter with a 4D vector (float)
     template <typename T, typename std::enable_if<detail::type_traits<T>::integral == 0, int>::type = 0>
-    void setUniform(const std::string &name, const Eigen::Matrix<T, 4, 1>  &v, bool warn = true) {
-        glUniform4f(uniform(name, warn), (float) v.x(), (float) v.y(), (float) v.z(), (float) v.w());
+    void setUniform(UniformHandle handle, const Eigen::Matrix<T, 4, 1>  &v) {
+        glUniform4f(handle.location, (float) v.x(), (float) v.y(), (float) v.z(), (float) v.w());
     }
 
     /// Initialize a uniform buffer with a uniform buffer object
@@ -261,20 +649,42 @@ public:
         return size;
     }
 
+    /// Check whether streamed attributes can use persistently mapped buffers in the current context (OpenGL 4.4 or ARB_buffer_storage)
+    static bool persistentMappingSupported();
+
+    /// Return the number of bytes transferred to vertex and index buffers by all shaders since the last reset
+    static size_t uploadedBytes();
+
+    /// Reset the counter of transferred bytes, e.g. at the beginning of each frame
+    static void resetUploadedBytes();
+
 public:
     /* Low-level API */
     void uploadAttrib(const std::string &name, size_t size, int dim,
                        uint32_t compSize, GLuint glType, bool integral,
                        const void *data, int version = -1);
+    void updateAttrib(const std::string &name, size_t offset, size_t size,
+                      uint32_t compSize, const void *data);
     void downloadAttrib(const std::string &name, size_t size, int dim,
                        uint32_t compSize, GLuint glType, void *data);
+    void uploadSharedAttrib(const std::string &name, size_t size, int dim,
+                            uint32_t compSize, GLuint glType, bool integral,
+                            const void *data);
+    void streamAttrib(const std::string &name, size_t size, int dim,
+                      uint32_t compSize, GLuint glType, bool integral,
+                      const void *data, int segments = 3);
+    void uploadVertices(const std::string &name,
+                        const std::vector<VertexAttribute> &attributes,
+                        size_t stride, size_t count, const void *data,
+                        int version = -1);
 
 protected:
     /**
      * \struct Buffer glutil.h nanogui/glutil.h
      *
      * A wrapper struct for maintaining various aspects of items being managed
-     * by OpenGL.
+     * by OpenGL. Interleaved vertices (see \ref uploadVertices()) are stored
+     * with one vertex per component and the attributes in \c layout.
      */
     struct Buffer {
         GLuint id;
@@ -283,6 +693,7 @@ protected:
         GLuint compSize;
         GLuint size;
         int version;
+        std::shared_ptr<const std::vector<VertexAttribute>> layout;
     };
     std::string mName;
     GLuint mVertexShader;
@@ -290,8 +701,40 @@ protected:
     GLuint mGeometryShader;
     GLuint mProgramShader;
     GLuint mVertexArrayObject;
+    GLuint mIndirectBuffer;
     std::map<std::string, Buffer> mBufferObjects;
+
+    /// Ring of buffer regions receiving an attribute through \ref streamAttrib()
+    struct StreamingBuffer {
+        GLuint id;
+        size_t segmentSize;
+        int segment;
+        uint8_t *mapped;
+        std::vector<GLsync> fences;
+    };
+    std::map<std::string, StreamingBuffer> mStreamingBuffers;
+
+    /// Release the buffer and fences of a streamed attribute
+    static void freeStreamingBuffer(StreamingBuffer &buffer);
+
+    /// Create or refresh a vertex or index buffer object
+    Buffer &uploadBuffer(const std::string &name, size_t size, int dim,
+                         uint32_t compSize, GLuint glType, const void *data,
+                         int version);
+
+    /// Point the attributes of an interleaved vertex buffer into it
+    void bindVertexLayout(const Buffer &buffer);
     std::map<std::string, std::string> mDefinitions;
+    std::string mSharedKey;
+
+    /// Locations of the active uniforms, uniform blocks and attributes (sorted by name)
+    struct Locations {
+        std::vector<std::pair<std::string, GLint>> uniforms, uniformBlocks, attribs;
+    };
+    std::shared_ptr<Locations> mLocations;
+
+    /// Query the locations of all active variables of a linked program
+    static std::shared_ptr<Locations> introspect(GLuint program);
 };
 
 //  ----------------------------------------------------
@@ -409,6 +852,9 @@ public:
     /// Return the number of MSAA samples
     int samples() const { return mSamples; }
 
+    /// Read back the framebuffer contents as 8 bit RGBA values, starting with the top left pixel
+    void downloadPixels(uint8_t *rgba);
+
     /// Quick and dirty method to write a TGA (32bpp RGBA) file of the framebuffer contents for debugging
     void downloadTGA(const std::string &filename);
 protected:
@@ -13,6 +13,9 @@
 #pragma once
 
 #include <nanogui/widget.h>
+#include <nanogui/graphdata.h>
+#include <memory>
+#include <cmath>
 
 NAMESPACE_BEGIN(nanogui)
 
@@ -20,42 +23,212 @@ NAMESPACE_BEGIN(nanogui)
  * \class Graph graph.h nanogui/graph.h
  *
  * \brief Simple graph widget for showing a function plot.
+ *
+ * The plotted values are either set as a whole through \ref setValues(), or
+ * streamed into a ring buffer after enabling it with \ref setStreamCapacity().
+ * In streaming mode, a single producer thread may call \ref push() and
+ * \ref pushBatch() concurrently with drawing, without any locks: samples are
+ * published with an atomic write index, and each frame draws the newest
+ * \ref streamCapacity() samples in place. The ring buffer holds at least
+ * as many samples again as slack. Like a sequence lock, the producer
+ * announces which samples it is about to overwrite, and a frame that was
+ * lapped while reading the samples (i.e. one during which more than the
+ * slack was pushed) is traced again from the newest samples; if that keeps
+ * failing, the series is skipped for that frame. To draw every frame, choose
+ * a capacity exceeding the number of samples pushed while one is drawn.
+ *
+ * For zooming and panning through long series, \ref setPyramidEnabled()
+ * maintains a min/max pyramid (levels of 2x reduction) next to the samples,
+ * which is updated incrementally as samples are pushed. Drawing a window of
+ * the series selected by \ref setRange() then only reads a few pyramid
+ * entries per pixel column, however many samples the window contains.
+ *
+ * Series that do not fit into memory can be supplied by a
+ * \ref GraphDataSource (e.g. a \ref MappedGraphDataSource) instead.
  */
 class NANOGUI_EXPORT Graph : public Widget {
 public:
     Graph(Widget *parent, const std::string &caption = "Untitled");
+    ~Graph();
 
     const std::string &caption() const { return mCaption; }
-    void setCaption(const std::string &caption) { mCaption = caption; }
+    void setCaption(const std::string &caption) { mCaption = caption; markDirty(); }
 
     const std::string &header() const { return mHeader; }
-    void setHeader(const std::string &header) { mHeader = header; }
+    void setHeader(const std::string &header) { mHeader = header; markDirty(); }
 
     const std::string &footer() const { return mFooter; }
-    void setFooter(const std::string &footer) { mFooter = footer; }
+    void setFooter(const std::string &footer) { mFooter = footer; markDirty(); }
 
     const Color &backgroundColor() const { return mBackgroundColor; }
-    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; }
+    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; markDirty(); }
 
     const Color &foregroundColor() const { return mForegroundColor; }
-    void setForegroundColor(const Color &foregroundColor) { mForegroundColor = foregroundColor; }
+    void setForegroundColor(const Color &foregroundColor) { mForegroundColor = foregroundColor; markDirty(); }
 
     const Color &textColor() const { return mTextColor; }
-    void setTextColor(const Color &textColor) { mTextColor = textColor; }
+    void setTextColor(const Color &textColor) { mTextColor = textColor; markDirty(); }
 
     const VectorXf &values() const { return mValues; }
+    /// Mutable access to the plotted values (call \ref markDirty() after modifying them, or \ref setValues() when a pyramid is enabled)
     VectorXf &values() { return mValues; }
-    void setValues(const VectorXf &values) { mValues = values; }
+    void setValues(const VectorXf &values);
+
+    /**
+     * \brief Plot the samples of the given source in place of \ref values()
+     * (or \ref values() again when \c source is \c nullptr)
+     *
+     * The source summarizes its own samples, so no pyramid is kept for it.
+     * Streaming mode takes precedence over the data source.
+     */
+    void setDataSource(GraphDataSource *source);
+    /// Return the data source plotted in place of \ref values() (or \c nullptr)
+    GraphDataSource *dataSource() { return mDataSource; }
+    /// Return the data source plotted in place of \ref values() (or \c nullptr)
+    const GraphDataSource *dataSource() const { return mDataSource.get(); }
+
+    /**
+     * \brief Switch to streaming mode, showing the given number of most
+     * recent samples (or back to \ref values() when \c capacity is zero)
+     *
+     * This discards previously streamed samples and must not be called while
+     * a producer is pushing samples.
+     */
+    void setStreamCapacity(size_t capacity);
+    /// Return the number of samples shown in streaming mode (zero if disabled)
+    size_t streamCapacity() const { return mStreamCapacity; }
+
+    /// Append a sample in streaming mode (may be called from one producer thread)
+    void push(float value);
+    /// Append \c count samples in streaming mode (may be called from one producer thread)
+    void pushBatch(const float *values, size_t count);
+
+    /// Return the total number of samples pushed since streaming was enabled
+    size_t streamCount() const { return mStreamHead.load(std::memory_order_acquire); }
+
+    /**
+     * \brief Maintain a min/max pyramid of the samples for fast drawing of
+     * long series at any zoom level
+     *
+     * In streaming mode, this must not be called while a producer is pushing
+     * samples. The pyramid takes about as much memory again as the samples.
+     */
+    void setPyramidEnabled(bool enabled);
+    /// Return whether a min/max pyramid is maintained
+    bool pyramidEnabled() const { return mPyramidEnabled; }
+
+    /**
+     * \brief Show only the samples with indices in <tt>[begin, end)</tt>
+     *
+     * Indices refer to \ref values() or the data source, or count the samples pushed since
+     * streaming was enabled. Samples that are no longer retained by the ring
+     * buffer are left blank. An empty range shows the whole series.
+     */
+    void setRange(size_t begin, size_t end) { mRangeBegin = begin; mRangeEnd = end; markDirty(); }
+    /// Return the first sample index of the range set by \ref setRange()
+    size_t rangeBegin() const { return mRangeBegin; }
+    /// Return the end of the range set by \ref setRange()
+    size_t rangeEnd() const { return mRangeEnd; }
 
     virtual Vector2i preferredSize(NVGcontext *ctx) const override;
     virtual void draw(NVGcontext *ctx) override;
 
     virtual void save(Serializer &s) const override;
     virtual bool load(Serializer &s) override;
+
+    /**
+     * \brief Trace the samples with indices in <tt>[begin, end)</tt> as a
+     * polyline, where sample \c i lies <tt>(i - origin) * dx</tt> pixels
+     * from the left edge of the plot
+     *
+     * Calls <tt>lineTo(x, value)</tt> for each vertex. With more than four
+     * samples per pixel column, only the first, smallest, largest and last
+     * sample of each column are emitted, which rasterizes to the same line
+     * while the number of vertices scales with the width. The smallest and
+     * largest sample are obtained from <tt>range(i0, i1, min, max)</tt>.
+     */
+    template <typename Sample, typename Range, typename LineTo>
+    static void traceSeries(size_t begin, size_t end, double origin, double dx,
+                            const Sample &sample, const Range &range,
+                            const LineTo &lineTo) {
+        auto vx = [&](size_t i) { return (float) ((i - origin) * dx); };
+        if (dx >= 0.25) {
+            for (size_t i = begin; i < end; i++)
+                lineTo(vx(i), sample(i));
+            return;
+        }
+        size_t i0 = begin;
+        for (int column = (int) std::floor((begin - origin) * dx); i0 < end; ++column) {
+            size_t i1 = (size_t) std::max(0.0, std::ceil(origin + (column + 1) / dx));
+            i1 = std::min(std::max(i1, i0 + 1), end);
+            float v0 = sample(i0);
+            lineTo(vx(i0), v0);
+            if (i1 - i0 > 2) {
+                float min, max, xc = column + 0.5f;
+                range(i0, i1, min, max);
+                bool minFirst = std::abs(v0 - min) <= std::abs(v0 - max);
+                lineTo(xc, minFirst ? min : max);
+                lineTo(xc, minFirst ? max : min);
+            }
+            if (i1 - i0 > 1)
+                lineTo(vx(i1 - 1), sample(i1 - 1));
+            i0 = i1;
+        }
+    }
+
+protected:
+    /**
+     * \brief Compute the outline of the samples with indices in <tt>[begin,
+     * end)</tt> into \ref mVertices, spaced such that the samples
+     * <tt>origin</tt> and <tt>origin + slots - 1</tt> lie on the left and
+     * right edge of the widget
+     */
+    void traceVertices(size_t begin, size_t end, double origin, size_t slots);
+
+    /// Fill and stroke the outline computed by \ref traceVertices()
+    void drawVertices(NVGcontext *ctx);
+
+    /// Return the sample with the given index
+    float sample(size_t index) const {
+        return mStreamCapacity > 0 ? mStream[index & mStreamMask] :
+               (mDataSource ? mDataSource->value(index) : mValues[index]);
+    }
+
+    /// Compute the range of the samples with indices in <tt>[begin, end)</tt>
+    void sampleRange(size_t begin, size_t end, float &min, float &max) const;
+
+    /// Recompute the pyramid entries covering the samples <tt>[begin, end)</tt>
+    void updatePyramid(size_t begin, size_t end);
+
+    /// Request a redraw of the screen showing this graph after new samples arrived
+    void notifyStream();
+
 protected:
     std::string mCaption, mHeader, mFooter;
     Color mBackgroundColor, mForegroundColor, mTextColor;
     VectorXf mValues;
+    ref<GraphDataSource> mDataSource;
+
+    /* Ring buffer of the streaming mode, with a power of two size */
+    std::unique_ptr<float[]> mStream;
+    size_t mStreamCapacity, mStreamMask;
+    std::atomic<size_t> mStreamHead;
+    /// End of the samples being written by the producer (at least \ref mStreamHead)
+    std::atomic<size_t> mStreamReserved;
+    /// Screen that last drew this graph; redrawn when samples are pushed
+    std::atomic<Screen *> mStreamScreen;
+
+    /**
+     * Min/max pyramid: entry \c j of level \c k (starting at 1) covers the
+     * samples <tt>[j << k, (j + 1) << k)</tt>. In streaming mode, each level is
+     * a ring buffer as well and entry \c j is stored at <tt>j & mask</tt>.
+     */
+    bool mPyramidEnabled;
+    std::vector<std::vector<float>> mPyramidMin, mPyramidMax;
+    size_t mRangeBegin, mRangeEnd;
+
+    /// Outline of the plotted samples, reused across frames
+    std::vector<Vector2f> mVertices;
 };
 
 NAMESPACE_END(nanogui)
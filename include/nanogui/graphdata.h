@@ -0,0 +1,127 @@
+/*
+    nanogui/graphdata.h -- Data sources supplying the samples plotted
+    by a Graph, including memory-mapped sample files
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/object.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class GraphDataSource graphdata.h nanogui/graphdata.h
+ *
+ * \brief Basic interface of a series of samples plotted by a \ref Graph.
+ *
+ * Sources are queried on the UI thread while drawing. Besides single
+ * samples, the graph asks for the range of every pixel column, which a
+ * source may answer from precomputed summaries instead of visiting each
+ * sample.
+ */
+class NANOGUI_EXPORT GraphDataSource : public Object {
+public:
+    /// Return the number of samples
+    virtual size_t size() const = 0;
+
+    /// Return the sample with the given index
+    virtual float value(size_t index) const = 0;
+
+    /// Compute the range of the samples with indices in <tt>[begin, end)</tt> (default: visit each sample)
+    virtual void range(size_t begin, size_t end, float &min, float &max) const;
+
+    /**
+     * \brief Redraw the given screen when more precise ranges become
+     * available (or stop doing so when \c screen is \c nullptr)
+     *
+     * Set by \ref Graph::draw() and reset by the graph when it is destroyed
+     * or switches to another source. Resetting must not return while the
+     * screen is still being redrawn from another thread.
+     */
+    virtual void setScreen(Screen * /* screen */) { }
+
+protected:
+    virtual ~GraphDataSource() { }
+};
+
+/**
+ * \class MappedGraphDataSource graphdata.h nanogui/graphdata.h
+ *
+ * \brief Series of raw 32 bit floats (in native byte order) read from a
+ *        memory-mapped file.
+ *
+ * Opening a file only maps it; the operating system pages in the parts that
+ * are drawn. The range of each block of \ref BlockSize samples is computed
+ * by a background thread, starting with the blocks most recently drawn, so
+ * that views spanning the whole file read cached summaries. Until a block
+ * is summarized, its range is estimated from a strided subsample, and the
+ * screen set via \ref setScreen() is redrawn as summaries become
+ * available. Pages that were read to compute the summaries are released
+ * again, keeping the resident memory bounded independently of the file
+ * size.
+ */
+class NANOGUI_EXPORT MappedGraphDataSource : public GraphDataSource {
+public:
+    /// Number of samples summarized by each cached range
+    static const size_t BlockSize = 4096;
+
+    /**
+     * \brief Map the given file, skipping \c offset bytes of header
+     *
+     * Throws \c std::runtime_error if the file cannot be opened or mapped.
+     */
+    MappedGraphDataSource(const std::string &filename, size_t offset = 0);
+
+    virtual size_t size() const override { return mSize; }
+    virtual float value(size_t index) const override { return mData[index]; }
+    virtual void range(size_t begin, size_t end, float &min, float &max) const override;
+    virtual void setScreen(Screen *screen) override;
+
+    /// Check whether the ranges of all blocks have been computed
+    bool summarized() const { return mSummarizedCount.load(std::memory_order_acquire) == mBlockCount; }
+
+protected:
+    virtual ~MappedGraphDataSource();
+
+    /// Compute the cached ranges of the blocks in <tt>[begin, end)</tt> that are not known yet
+    void summarize(size_t begin, size_t end);
+
+    /// Body of the background thread computing the block summaries
+    void run();
+
+protected:
+    const float *mData;
+    size_t mSize;
+    void *mMapping;
+    size_t mMappingSize;
+#if defined(_WIN32)
+    void *mFile, *mMappingHandle;
+#endif
+    size_t mBlockCount;
+    std::vector<float> mBlockMin, mBlockMax;
+    std::unique_ptr<std::atomic<bool>[]> mBlockValid;
+
+    /* State shared with the background thread */
+    std::atomic<size_t> mSummarizedCount;
+    mutable std::atomic<size_t> mRequested;
+    std::atomic<bool> mStop;
+    std::mutex mScreenMutex;
+    Screen *mScreen;
+    std::thread mThread;
+};
+
+NAMESPACE_END(nanogui)
@@ -28,7 +28,7 @@ public:
 public:
     ImagePanel(Widget *parent);
 
-    void setImages(const Images &data) { mImages = data; }
+    void setImages(const Images &data) { mImages = data; invalidatePreferredSize(); markDirty(); }
     const Images& images() const { return mImages; }
 
     std::function<void(int)> callback() const { return mCallback; }
@@ -16,7 +16,9 @@
 
 #include <nanogui/widget.h>
 #include <nanogui/glutil.h>
+#include <nanogui/streamingtexture.h>
 #include <functional>
+#include <memory>
 
 NAMESPACE_BEGIN(nanogui)
 
@@ -24,6 +26,16 @@ NAMESPACE_BEGIN(nanogui)
  * \class ImageView imageview.h nanogui/imageview.h
  *
  * \brief Widget used to display images.
+ *
+ * The image is either a single OpenGL texture or a \ref TiledImageSource,
+ * which allows showing images exceeding the texture size limit or the
+ * available memory. For tiled images, only the tiles of the mipmap level
+ * matching the current scale that intersect the widget are loaded (in the
+ * background) into a fixed-size \ref TileCache. Until a tile is available,
+ * the corresponding part of the next coarser resident level is shown.
+ *
+ * A \ref StreamingTexture shows frames pushed from another thread, such as
+ * a video feed, always displaying the newest frame that finished uploading.
  */
 class NANOGUI_EXPORT ImageView : public Widget {
 public:
@@ -32,6 +44,17 @@ public:
 
     void bindImage(GLuint imageId);
 
+    /// Display a tiled image using a GPU cache of \c cacheCapacity tiles
+    void bindTiledImage(TiledImageSource *source, int cacheCapacity = 256);
+    /// Return the cache of the tiled image (or \c nullptr when displaying a texture)
+    const TileCache *tileCache() const { return mTileCache.get(); }
+
+    /// Display the frames of a streaming texture (e.g. fed by a camera thread)
+    void bindStreamingTexture(StreamingTexture *texture);
+    /// Return the bound streaming texture (or \c nullptr)
+    StreamingTexture *streamingTexture() { return mStreamingTexture; }
+    const StreamingTexture *streamingTexture() const { return mStreamingTexture.get(); }
+
     GLShader& imageShader() { return mShader; }
 
     Vector2f positionF() const { return mPos.cast<float>(); }
@@ -43,9 +66,9 @@ public:
     Vector2f scaledImageSizeF() const { return (mScale * mImageSize.cast<float>()); }
 
     const Vector2f& offset() const { return mOffset; }
-    void setOffset(const Vector2f& offset) { mOffset = offset; }
+    void setOffset(const Vector2f& offset) { mOffset = offset; markDirty(); }
     float scale() const { return mScale; }
-    void setScale(float scale) { mScale = scale > 0.01f ? scale : 0.01f; }
+    void setScale(float scale) { mScale = scale > 0.01f ? scale : 0.01f; markDirty(); }
 
     bool fixedOffset() const { return mFixedOffset; }
     void setFixedOffset(bool fixedOffset) { mFixedOffset = fixedOffset; }
@@ -56,21 +79,29 @@ public:
     void setZoomSensitivity(float zoomSensitivity) { mZoomSensitivity = zoomSensitivity; }
 
     float gridThreshold() const { return mGridThreshold; }
-    void setGridThreshold(float gridThreshold) { mGridThreshold = gridThreshold; }
+    void setGridThreshold(float gridThreshold) { mGridThreshold = gridThreshold; markDirty(); }
 
     float pixelInfoThreshold() const { return mPixelInfoThreshold; }
-    void setPixelInfoThreshold(float pixelInfoThreshold) { mPixelInfoThreshold = pixelInfoThreshold; }
+    void setPixelInfoThreshold(float pixelInfoThreshold) { mPixelInfoThreshold = pixelInfoThreshold; markDirty(); }
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     void setPixelInfoCallback(const std::function<std::pair<std::string, Color>(const Vector2i&)>& callback) {
         mPixelInfoCallback = callback;
+        invalidatePixelInfo();
     }
     const std::function<std::pair<std::string, Color>(const Vector2i&)>& pixelInfoCallback() const {
         return mPixelInfoCallback;
     }
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
-    void setFontScaleFactor(float fontScaleFactor) { mFontScaleFactor = fontScaleFactor; }
+    /**
+     * Discards the cached pixel information. The callback is only queried again when the
+     * visible pixels or the image change, so call this function when the information of
+     * the visible pixels changes otherwise.
+     */
+    void invalidatePixelInfo() { mPixelInfoValid = false; markDirty(); }
+
+    void setFontScaleFactor(float fontScaleFactor) { mFontScaleFactor = fontScaleFactor; markDirty(); }
     float fontScaleFactor() const { return mFontScaleFactor; }
 
     // Image transformation functions.
@@ -135,21 +166,22 @@ public:
 private:
     // Helper image methods.
     void updateImageParameters();
+    void initShader(bool tiled);
+    void drawTiles(const Vector2f& screenSize, const Vector2f& imagePosition, float pixelRatio);
 
     // Helper drawing methods.
     void drawWidgetBorder(NVGcontext* ctx) const;
     void drawImageBorder(NVGcontext* ctx) const;
-    void drawHelpers(NVGcontext* ctx) const;
-    static void drawPixelGrid(NVGcontext* ctx, const Vector2f& upperLeftCorner,
-                              const Vector2f& lowerRightCorner, float stride);
-    void drawPixelInfo(NVGcontext* ctx, float stride) const;
-    void writePixelInfo(NVGcontext* ctx, const Vector2f& cellPosition,
-                        const Vector2i& pixel, float stride, float fontSize) const;
+    void drawHelpers(NVGcontext* ctx);
+    void drawPixelInfo(NVGcontext* ctx, float stride);
+    void updatePixelInfo(const Vector2i& topLeft, const Vector2i& bottomRight);
 
     // Image parameters.
     GLShader mShader;
     GLuint mImageID;
     Vector2i mImageSize;
+    std::unique_ptr<TileCache> mTileCache;
+    ref<StreamingTexture> mStreamingTexture;
 
     // Image display parameters.
     float mScale;
@@ -166,6 +198,20 @@ private:
 
     // Image pixel data display members.
     std::function<std::pair<std::string, Color>(const Vector2i&)> mPixelInfoCallback;
+
+    // Cached pixel information of the visible pixels, grouped by color, with
+    // the width of each text at the font size mPixelInfoFontSize.
+    struct PixelText {
+        Vector2i pixel;
+        int row, rows;
+        std::string text;
+        float width;
+    };
+    std::vector<std::pair<Color, std::vector<PixelText>>> mPixelInfoLayout;
+    float mPixelInfoFontSize = -1;
+    Vector2i mPixelInfoTopLeft, mPixelInfoBottomRight;
+    bool mPixelInfoValid = false;
+    size_t mPixelInfoFrame = 0;
     float mFontScaleFactor = 0.2f;
 };
 
@@ -32,17 +32,17 @@ public:
     /// Get the label's text caption
     const std::string &caption() const { return mCaption; }
     /// Set the label's text caption
-    void setCaption(const std::string &caption) { mCaption = caption; }
+    void setCaption(const std::string &caption) { mCaption = caption; invalidatePreferredSize(); markDirty(); }
 
     /// Set the currently active font (2 are available by default: 'sans' and 'sans-bold')
-    void setFont(const std::string &font) { mFont = font; }
+    void setFont(const std::string &font) { mFont = font; invalidatePreferredSize(); markDirty(); }
     /// Get the currently active font
     const std::string &font() const { return mFont; }
 
     /// Get the label color
     Color color() const { return mColor; }
     /// Set the label color
-    void setColor(const Color& color) { mColor = color; }
+    void setColor(const Color& color) { mColor = color; markDirty(); }
 
     /// Set the \ref Theme used to draw this widget
     virtual void setTheme(Theme *theme) override;
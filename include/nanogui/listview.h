@@ -0,0 +1,121 @@
+/*
+    nanogui/listview.h -- Scrollable list that only instantiates widgets
+    for the visible rows of a (potentially huge) data source
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/widget.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class ListView listview.h nanogui/listview.h
+ *
+ * \brief Vertically scrolling list of rows with a fixed height, backed by a
+ *        data source callback.
+ *
+ * Unlike \ref VScrollPanel, which scrolls a child holding one widget per
+ * row, the list view only keeps widgets for the visible rows plus a few
+ * rows of overscan. When scrolling, rows leaving the viewport are recycled
+ * and bound to the newly exposed data rows, so that memory usage and frame
+ * time do not depend on the number of rows.
+ *
+ * The data source consists of a callback returning the number of rows and
+ * a callback that binds a row widget to a given row index (e.g. by setting
+ * the caption of a \ref Label). Row widgets are created by the row factory
+ * callback, which defaults to creating labels. Call \ref reloadData() when
+ * the contents of the data source change.
+ */
+class NANOGUI_EXPORT ListView : public Widget {
+public:
+    ListView(Widget *parent);
+
+    /// Set the callback returning the number of rows of the data source
+    void setRowCountCallback(const std::function<size_t()> &callback);
+    /// Return the callback returning the number of rows of the data source
+    std::function<size_t()> rowCountCallback() const { return mRowCountCallback; }
+
+    /// Set the callback binding a row widget to the row with the given index
+    void setBindRowCallback(const std::function<void(Widget *, size_t)> &callback);
+    /// Return the callback binding a row widget to the row with the given index
+    std::function<void(Widget *, size_t)> bindRowCallback() const { return mBindRowCallback; }
+
+    /// Set the callback creating a new (unbound) row widget as a child of the given widget
+    void setCreateRowCallback(const std::function<Widget *(Widget *)> &callback);
+    /// Return the callback creating a new (unbound) row widget
+    std::function<Widget *(Widget *)> createRowCallback() const { return mCreateRowCallback; }
+
+    /// Return the height of each row in pixels
+    int rowHeight() const { return mRowHeight; }
+    /// Set the height of each row in pixels
+    void setRowHeight(int rowHeight);
+
+    /// Return the number of extra rows kept bound above and below the viewport
+    int overscan() const { return mOverscan; }
+    /// Set the number of extra rows kept bound above and below the viewport
+    void setOverscan(int overscan);
+
+    /// Return the number of rows of the data source
+    size_t rowCount() const { return mRowCountCallback ? mRowCountCallback() : 0; }
+
+    /// Return the scroll offset in pixels
+    float scroll() const { return mScroll; }
+    /// Set the scroll offset in pixels (clamped to the scrollable range)
+    void setScroll(float scroll);
+
+    /// Scroll such that the given row is visible
+    void scrollToRow(size_t index);
+
+    /// Return the index of the row at the top of the viewport
+    size_t firstVisibleRow() const { return (size_t) (mScroll / mRowHeight); }
+
+    /// Return the row widget currently bound to the given row index (or \c nullptr)
+    Widget *rowWidget(size_t index);
+
+    /// Return the number of row widgets that were created
+    size_t rowWidgetCount() const { return mRows.size(); }
+
+    /// Rebind all row widgets, e.g. after the data source changed
+    void reloadData();
+
+    virtual void performLayout(NVGcontext *ctx) override;
+    virtual Vector2i preferredSize(NVGcontext *ctx) const override;
+    virtual bool mouseDragEvent(const Vector2i &p, const Vector2i &rel, int button, int modifiers) override;
+    virtual bool scrollEvent(const Vector2i &p, const Vector2f &rel) override;
+    virtual void draw(NVGcontext *ctx) override;
+    virtual void save(Serializer &s) const override;
+    virtual bool load(Serializer &s) override;
+
+protected:
+    /// Return the total height of all rows in pixels
+    float contentHeight() const { return (float) rowCount() * mRowHeight; }
+
+    /// Create or remove row widgets so that they cover the viewport plus overscan
+    void updatePool();
+
+    /// Position the row widgets and bind those that were exposed by scrolling
+    void updateRows(bool rebind = false);
+
+protected:
+    std::function<size_t()> mRowCountCallback;
+    std::function<void(Widget *, size_t)> mBindRowCallback;
+    std::function<Widget *(Widget *)> mCreateRowCallback;
+    /// Pool of row widgets; the row with index \c i is bound to <tt>mRows[i % mRows.size()]</tt>
+    std::vector<Widget *> mRows;
+    /// Row index currently bound to each entry of \ref mRows (or \c -1)
+    std::vector<size_t> mRowIndex;
+    int mRowHeight;
+    int mOverscan;
+    float mScroll;
+};
+
+NAMESPACE_END(nanogui)
@@ -31,11 +31,18 @@
 #include <nanogui/slider.h>
 #include <nanogui/imagepanel.h>
 #include <nanogui/imageview.h>
+#include <nanogui/tiledimage.h>
+#include <nanogui/streamingtexture.h>
 #include <nanogui/vscrollpanel.h>
+#include <nanogui/listview.h>
 #include <nanogui/colorwheel.h>
 #include <nanogui/graph.h>
+#include <nanogui/graphdata.h>
+#include <nanogui/sparklinegrid.h>
 #include <nanogui/formhelper.h>
 #include <nanogui/stackedwidget.h>
 #include <nanogui/tabheader.h>
 #include <nanogui/tabwidget.h>
 #include <nanogui/glcanvas.h>
+#include <nanogui/plotcanvas.h>
+#include <nanogui/profiler.h>
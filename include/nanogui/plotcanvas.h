@@ -0,0 +1,111 @@
+/*
+    nanogui/plotcanvas.h -- Canvas widget plotting line series with
+    OpenGL, for dense data where NanoVG paths become too expensive
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/glcanvas.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class PlotCanvas plotcanvas.h nanogui/plotcanvas.h
+ *
+ * \brief Canvas widget plotting several line series with a shader.
+ *
+ * Each series shows its most recent samples, up to a fixed capacity. The
+ * samples live in a single vertex buffer shared by all series, where every
+ * sample is stored twice (at its ring buffer slot and one capacity further)
+ * so that the visible samples of a series are always contiguous and are
+ * drawn by one \c GL_LINE_STRIP. New samples are transferred with
+ * sub-buffer updates before the next frame; the whole buffer is only
+ * uploaded again after adding a series. The horizontal position of each
+ * vertex is computed in the vertex shader.
+ *
+ * Axes with tick labels for the vertical range are drawn on top with NanoVG.
+ * Only OpenGL 3.3 core functionality is used, so the widget also renders on
+ * software implementations such as llvmpipe.
+ */
+class NANOGUI_EXPORT PlotCanvas : public GLCanvas {
+public:
+    PlotCanvas(Widget *parent);
+
+    /// Add a series showing the given number of most recent samples and return its index
+    int addSeries(size_t capacity, const Color &color);
+    /// Return the number of series
+    int seriesCount() const { return (int) mSeries.size(); }
+
+    /// Return the color of a series
+    const Color &seriesColor(int series) const { return mSeries[series].color; }
+    /// Set the color of a series
+    void setSeriesColor(int series, const Color &color) { mSeries[series].color = color; markDirty(); }
+
+    /// Return the number of samples a series shows at most
+    size_t seriesCapacity(int series) const { return mSeries[series].capacity; }
+    /// Return the total number of samples appended to a series
+    size_t sampleCount(int series) const { return mSeries[series].head; }
+
+    /// Append a sample to a series
+    void push(int series, float value) { pushBatch(series, &value, 1); }
+    /// Append \c count samples to a series
+    void pushBatch(int series, const float *values, size_t count);
+    /// Remove all samples of a series
+    void clearSeries(int series);
+
+    /// Return the range of values spanning the height of the canvas
+    const Vector2f &yRange() const { return mYRange; }
+    /// Set the range of values spanning the height of the canvas
+    void setYRange(const Vector2f &yRange) { mYRange = yRange; markDirty(); }
+
+    /// Return whether the axes overlay is drawn
+    bool axesVisible() const { return mAxesVisible; }
+    /// Set whether the axes overlay is drawn
+    void setAxesVisible(bool visible) { mAxesVisible = visible; markDirty(); }
+
+    /// Return the number of intervals between the ticks of the vertical axis
+    int tickCount() const { return mTickCount; }
+    /// Set the number of intervals between the ticks of the vertical axis
+    void setTickCount(int count) { mTickCount = std::max(count, 1); markDirty(); }
+
+    virtual void draw(NVGcontext *ctx) override;
+    virtual void drawGL() override;
+    virtual void save(Serializer &s) const override;
+    virtual bool load(Serializer &s) override;
+
+protected:
+    virtual ~PlotCanvas();
+
+    /// Transfer the samples appended to a series since the last frame
+    void uploadSeries(size_t index);
+
+protected:
+    struct Series {
+        /// Samples in ring buffer order; sample \c i is stored at <tt>i % capacity</tt>
+        std::vector<float> values;
+        size_t capacity;
+        /// Number of samples appended / transferred so far
+        size_t head, uploaded;
+        /// First vertex of this series in the shared buffer (which holds \c 2*capacity vertices per series)
+        size_t offset;
+        Color color;
+    };
+
+    GLShader mShader;
+    std::vector<Series> mSeries;
+    /// Whether the shared vertex buffer has been allocated for the current series
+    bool mBufferValid;
+    Vector2f mYRange;
+    bool mAxesVisible;
+    int mTickCount;
+};
+
+NAMESPACE_END(nanogui)
@@ -28,7 +28,7 @@ public:
     PopupButton(Widget *parent, const std::string &caption = "Untitled",
                 int buttonIcon = 0);
 
-    void setChevronIcon(int icon) { mChevronIcon = icon; }
+    void setChevronIcon(int icon) { mChevronIcon = icon; markDirty(); }
     int chevronIcon() const { return mChevronIcon; }
 
     void setSide(Popup::Side popupSide);
@@ -0,0 +1,166 @@
+/*
+    nanogui/profiler.h -- Hierarchical per-frame profiler with Chrome trace
+    export
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/common.h>
+#include <deque>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class Profiler profiler.h nanogui/profiler.h
+ *
+ * \brief Records nested timing scopes of the frames drawn by all screens.
+ *
+ * NanoGUI instruments layout, the \c draw() method of every widget, event
+ * dispatch, \c nvgEndFrame() and the buffer swap using \ref ProfileScope
+ * instances. This instrumentation is only compiled in when NanoGUI is built
+ * with the CMake option \c NANOGUI_PROFILE and only records anything while
+ * the profiler is enabled via \ref setEnabled().
+ *
+ * The most recent events are kept in memory (see \ref setCapacity()). They
+ * can be inspected via \ref events() and \ref summary(), or written to a
+ * file in the Chrome \c trace_event format (\ref saveChromeTrace()), which
+ * can be opened in \c chrome://tracing or Perfetto.
+ */
+class NANOGUI_EXPORT Profiler {
+public:
+    /// A completed (or still running) timing scope
+    struct Event {
+        /// Name of the scope, e.g. the class name or id of a widget
+        std::string name;
+        /// Category of the scope (\c "layout", \c "draw", \c "event", ..)
+        const char *category;
+        /// Start time in microseconds
+        double start;
+        /// Duration in microseconds (negative while the scope is running)
+        double duration;
+        /// Nesting depth (0 for top-level scopes)
+        uint32_t depth;
+        /// Index of the frame during which the scope started
+        uint32_t frame;
+    };
+
+    /// Aggregated timings of all events sharing a category and name
+    struct Entry {
+        std::string name;
+        const char *category;
+        /// Number of recorded events
+        size_t count;
+        /// Total time in microseconds including nested scopes
+        double totalTime;
+        /// Total time in microseconds excluding nested scopes
+        double selfTime;
+    };
+
+    /// Start or stop recording events
+    static void setEnabled(bool enabled) { sEnabled = enabled; }
+    /// Return whether events are currently being recorded
+    static bool enabled() { return sEnabled; }
+
+    /// Set the maximum number of retained events (older frames are discarded first)
+    static void setCapacity(size_t capacity);
+    /// Return the maximum number of retained events
+    static size_t capacity() { return sCapacity; }
+
+    /// Mark the beginning of a new frame (called by \ref Screen::drawAll())
+    static void beginFrame();
+    /// Return the index of the current frame
+    static uint32_t frame() { return sFrame; }
+
+    /// Open a new scope nested within the currently running ones
+    static void begin(const char *category, const std::string &name);
+    /// Close the innermost running scope
+    static void end();
+
+    /// Return all retained events in the order in which their scopes were opened
+    static const std::deque<Event> &events() { return sEvents; }
+
+    /**
+     * \brief Aggregate the retained events by category and name
+     *
+     * When \c frame is nonnegative, only events of the given frame are
+     * considered. The entries are sorted by decreasing total time.
+     */
+    static std::vector<Entry> summary(int64_t frame = -1);
+
+    /// Discard all retained events
+    static void clear();
+
+    /// Write the retained events into a Chrome \c trace_event JSON file
+    static void saveChromeTrace(const std::string &filename);
+
+    /// Return a descriptive name for a widget (its id, or otherwise its class name)
+    static std::string widgetName(const Widget *widget);
+
+protected:
+    static bool sEnabled;
+    static size_t sCapacity;
+    static uint32_t sFrame;
+    static std::deque<Event> sEvents;
+    /// Indices of the running scopes within \ref sEvents
+    static std::vector<size_t> sStack;
+};
+
+/**
+ * \class ProfileScope profiler.h nanogui/profiler.h
+ *
+ * \brief Records the lifetime of the object as a \ref Profiler event.
+ *
+ * Usually created through the \ref NANOGUI_PROFILE_SCOPE() and \ref
+ * NANOGUI_PROFILE_WIDGET() macros, which expand to nothing unless NanoGUI
+ * was built with \c NANOGUI_PROFILE.
+ */
+class ProfileScope {
+public:
+    ProfileScope(const char *category, const char *name)
+        : mActive(Profiler::enabled()) {
+        if (mActive)
+            Profiler::begin(category, name);
+    }
+
+    ProfileScope(const char *category, const Widget *widget)
+        : mActive(Profiler::enabled()) {
+        if (mActive)
+            Profiler::begin(category, Profiler::widgetName(widget));
+    }
+
+    ~ProfileScope() {
+        if (mActive)
+            Profiler::end();
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    bool mActive;
+};
+
+NAMESPACE_END(nanogui)
+
+#define NANOGUI_PROFILE_CONCAT_(a, b) a ## b
+#define NANOGUI_PROFILE_CONCAT(a, b) NANOGUI_PROFILE_CONCAT_(a, b)
+
+#if defined(NANOGUI_PROFILE)
+/// Record the remainder of the enclosing block as a profiler scope
+#  define NANOGUI_PROFILE_SCOPE(category, name) \
+       ::nanogui::ProfileScope NANOGUI_PROFILE_CONCAT(__nanogui_profile_, __LINE__)(category, name)
+/// Record the remainder of the enclosing block as a profiler scope named after a widget
+#  define NANOGUI_PROFILE_WIDGET(category, widget) \
+       ::nanogui::ProfileScope NANOGUI_PROFILE_CONCAT(__nanogui_profile_, __LINE__)(category, (const ::nanogui::Widget *) (widget))
+#else
+#  define NANOGUI_PROFILE_SCOPE(category, name) ((void) 0)
+#  define NANOGUI_PROFILE_WIDGET(category, widget) ((void) 0)
+#endif
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <nanogui/widget.h>
+#include <nanogui/profiler.h>
 
 NAMESPACE_BEGIN(nanogui)
 
@@ -23,10 +24,14 @@ NAMESPACE_BEGIN(nanogui)
  *
  * \brief Represents a display surface (i.e. a full-screen or windowed GLFW window)
  * and forms the root element of a hierarchy of nanogui widgets.
+ *
+ * A screen can also be created without a window (see the headless
+ * constructor below), in which case it renders into an offscreen framebuffer.
  */
 class NANOGUI_EXPORT Screen : public Widget {
     friend class Widget;
     friend class Window;
+    friend void mainloop(int refresh);
 public:
     /**
      * Create a new Screen instance
@@ -83,6 +88,36 @@ public:
            int nSamples = 0,
            unsigned int glMajor = 3, unsigned int glMinor = 3);
 
+    /**
+     * \brief Create a headless Screen that renders into an offscreen framebuffer
+     *
+     * No window is created and GLFW does not need to be initialized. The
+     * OpenGL context is obtained through EGL (preferably using Mesa's
+     * surfaceless platform), which also works on hosts without a GPU or
+     * display server. This requires NanoGUI to be compiled with the CMake
+     * option \c NANOGUI_HEADLESS; otherwise, an exception is thrown.
+     *
+     * Headless screens do not take part in \ref mainloop(). Instead, the
+     * application calls \ref drawAll() to render a frame and injects input
+     * using the callback event handlers (e.g. \ref cursorPosCallbackEvent()),
+     * which behave exactly like in the windowed case. Mouse positions are
+     * thus specified in framebuffer pixels.
+     *
+     * \param size
+     *     Size of the screen in pixels at 96 dpi
+     *
+     * \param pixelRatio
+     *     Ratio between framebuffer and screen pixels
+     *
+     * \param glMajor
+     *     The requested OpenGL Major version number (core profile)
+     *
+     * \param glMinor
+     *     The requested OpenGL Minor version number (core profile)
+     */
+    Screen(const Vector2i &size, float pixelRatio,
+           unsigned int glMajor = 3, unsigned int glMinor = 3);
+
     /// Release all resources
     virtual ~Screen();
 
@@ -96,7 +131,7 @@ public:
     const Color &background() const { return mBackground; }
 
     /// Set the screen's background color
-    void setBackground(const Color &background) { mBackground = background; }
+    void setBackground(const Color &background) { mBackground = background; mRedraw = true; }
 
     /// Set the top-level window visibility (no effect on full-screen windows)
     void setVisible(bool visible);
@@ -110,6 +145,33 @@ public:
     /// Draw the window contents --- put your OpenGL draw calls here
     virtual void drawContents() { /* To be overridden */ }
 
+    /**
+     * \brief Request that the screen is redrawn during the next main loop
+     * iteration (may be called from any thread)
+     *
+     * The first request after a frame wakes up the main loop, which would
+     * otherwise only notice it after the next input or refresh event.
+     */
+    void redraw();
+
+    /// Return whether a redraw has been requested since the last frame
+    bool redrawPending() const { return mRedraw; }
+
+    /// Return the number of frames that were drawn
+    size_t renderedFrames() const { return mRenderedFrames; }
+
+    /// Return the number of main loop iterations that skipped drawing since nothing changed
+    size_t skippedFrames() const { return mSkippedFrames; }
+
+    /**
+     * \brief Return the number of widgets that were culled during the last frame
+     *
+     * Widgets lying entirely outside of the scissor rectangle of their parent
+     * (e.g. content scrolled out of a \ref VScrollPanel) are skipped together
+     * with their subtree. Each skipped subtree counts once.
+     */
+    size_t culledWidgets() const { return mCulledWidgets; }
+
     /// Return the ratio between pixel and device coordinates (e.g. >= 2 on Mac Retina displays)
     float pixelRatio() const { return mPixelRatio; }
 
@@ -128,6 +190,29 @@ public:
     /// Return the last observed mouse position value
     Vector2i mousePos() const { return mMousePos; }
 
+    /// Return whether the screen renders into an offscreen framebuffer instead of a window
+    bool headless() const { return mFramebuffer != nullptr; }
+
+    /**
+     * \brief Copy the contents of the last frame into \c rgba
+     *
+     * Stores 8 bit RGBA values of the framebuffer resolution, starting
+     * with the top left pixel. Only supported by headless screens.
+     */
+    void downloadPixels(std::vector<uint8_t> &rgba);
+
+    /// Write the contents of the last frame into a TGA file (only supported by headless screens)
+    void downloadTGA(const std::string &filename);
+
+    /**
+     * \brief Return the time in seconds used to timestamp events
+     *
+     * Queries \c glfwGetTime() for windowed screens. Headless screens
+     * measure the time elapsed since their construction instead, since
+     * GLFW may not be initialized.
+     */
+    virtual double time() const;
+
     /// Return a pointer to the underlying GLFW window data structure
     GLFWwindow *glfwWindow() { return mGLFWWindow; }
 
@@ -141,9 +226,24 @@ public:
 
     /// Compute the layout of all widgets
     void performLayout() {
+        NANOGUI_PROFILE_SCOPE("layout", "performLayout");
         Widget::performLayout(mNVGContext);
+        clearLayoutDirty();
+        mRedraw = true;
     }
 
+    /**
+     * \brief Lay out the widgets that were marked by \ref
+     * Widget::markLayoutDirty() since the last call
+     *
+     * Only the marked subtrees are visited. This is done automatically by
+     * \ref drawAll() before every frame.
+     */
+    void updateLayout();
+
+    /// Return the number of widgets that were laid out by the last call to \ref updateLayout()
+    size_t layoutRoots() const { return mLayoutRoots; }
+
 public:
     /********* API for applications which manage GLFW themselves *********/
 
@@ -180,6 +280,10 @@ public:
     void moveWindowToFront(Window *window);
     void drawWidgets();
 
+protected:
+    /// Make the OpenGL context current and bind the offscreen framebuffer (if any)
+    void makeContextCurrent();
+
 protected:
     GLFWwindow *mGLFWWindow;
     NVGcontext *mNVGContext;
@@ -198,6 +302,13 @@ protected:
     std::string mCaption;
     bool mShutdownGLFWOnDestruct;
     bool mFullscreen;
+    std::atomic<bool> mRedraw;
+    size_t mRenderedFrames, mSkippedFrames, mCulledWidgets;
+    size_t mLayoutRoots;
+    /* Offscreen render target and EGL state of headless screens */
+    GLFramebuffer *mFramebuffer;
+    void *mEGLDisplay, *mEGLContext;
+    double mStartTime;
 };
 
 NAMESPACE_END(nanogui)
@@ -14,6 +14,7 @@
 
 #include <nanogui/serializer/core.h>
 #include <nanogui/glutil.h>
+#include <algorithm>
 #include <set>
 
 NAMESPACE_BEGIN(nanogui)
@@ -22,6 +23,41 @@ NAMESPACE_BEGIN(detail)
 // bypass template specializations
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 
+template<>
+struct serialization_helper<VertexAttribute> {
+    static std::string type_id() {
+        return "A";
+    }
+
+    static void write(Serializer &s, const VertexAttribute *value, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t integral = value->integral ? 1 : 0;
+            uint64_t offset = (uint64_t) value->offset;
+            serialization_helper<std::string>::write(s, &value->name, 1);
+            serialization_helper<int32_t>::write(s, &value->dim, 1);
+            serialization_helper<uint32_t>::write(s, &value->glType, 1);
+            serialization_helper<uint8_t>::write(s, &integral, 1);
+            serialization_helper<uint64_t>::write(s, &offset, 1);
+            ++value;
+        }
+    }
+
+    static void read(Serializer &s, VertexAttribute *value, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            uint8_t integral;
+            uint64_t offset;
+            serialization_helper<std::string>::read(s, &value->name, 1);
+            serialization_helper<int32_t>::read(s, &value->dim, 1);
+            serialization_helper<uint32_t>::read(s, &value->glType, 1);
+            serialization_helper<uint8_t>::read(s, &integral, 1);
+            serialization_helper<uint64_t>::read(s, &offset, 1);
+            value->integral = integral != 0;
+            value->offset = (size_t) offset;
+            ++value;
+        }
+    }
+};
+
 template<>
 struct serialization_helper<GLShader> {
     static std::string type_id() {
@@ -41,6 +77,8 @@ struct serialization_helper<GLShader> {
                 s.set("dim", buf.dim);
                 s.set("size", buf.size);
                 s.set("version", buf.version);
+                if (buf.layout)
+                    s.set("layout", *buf.layout);
                 Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic> temp(1, totalSize);
 
                 if (item.first == "indices") {
@@ -89,6 +127,13 @@ struct serialization_helper<GLShader> {
                 s.get("size", buf.size);
                 s.get("version", buf.version);
                 s.get("data", data);
+                if (std::find(all_keys.begin(), all_keys.end(), key + ".layout") != all_keys.end()) {
+                    std::vector<VertexAttribute> layout;
+                    s.get("layout", layout);
+                    buf.layout = std::make_shared<const std::vector<VertexAttribute>>(layout);
+                } else {
+                    buf.layout.reset();
+                }
                 s.pop();
 
                 size_t totalSize = (size_t) buf.size * (size_t) buf.compSize;
@@ -96,6 +141,12 @@ struct serialization_helper<GLShader> {
                     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf.id);
                     glBufferData(GL_ELEMENT_ARRAY_BUFFER, totalSize,
                                  (void *) data.data(), GL_DYNAMIC_DRAW);
+                } else if (buf.layout) {
+                    /* Interleaved vertices */
+                    glBindBuffer(GL_ARRAY_BUFFER, buf.id);
+                    glBufferData(GL_ARRAY_BUFFER, totalSize, (void *) data.data(),
+                                 GL_DYNAMIC_DRAW);
+                    value->bindVertexLayout(buf);
                 } else {
                     int attribID = value->attrib(key);
                     glEnableVertexAttribArray(attribID);
@@ -0,0 +1,114 @@
+/*
+    nanogui/sparklinegrid.h -- Grid of small function plots drawn with
+    a few batched NanoVG paths
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/widget.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class SparklineGrid sparklinegrid.h nanogui/sparklinegrid.h
+ *
+ * \brief Grid of small plots in the style of \ref Graph.
+ *
+ * Showing hundreds of series with one \ref Graph each costs a separate set
+ * of paths and state changes per graph. This widget instead lays out its
+ * series in a grid of equally sized cells and draws all cells together:
+ * one path for the backgrounds, one for the plots (filled and stroked
+ * once) and one for the borders. Texts are drawn with one font setup per
+ * text style, but NanoVG still renders each caption and header with its
+ * own \c nvgText() call. Their widths come from the theme's \ref
+ * TextMetrics cache, which is used to right-align the headers and to clip
+ * texts that are wider than their cell. Series with more than four samples
+ * per pixel column are reduced to per-column envelopes using \ref
+ * Graph::traceSeries().
+ *
+ * Values are expected to lie in <tt>[0, 1]</tt>.
+ */
+class NANOGUI_EXPORT SparklineGrid : public Widget {
+public:
+    SparklineGrid(Widget *parent);
+
+    /// Add a series and return its index
+    int addSeries(const std::string &caption = "");
+    /// Return the number of series
+    int seriesCount() const { return (int) mSeries.size(); }
+
+    const std::string &caption(int series) const { return mSeries[series].caption; }
+    void setCaption(int series, const std::string &caption) { mSeries[series].caption = caption; markDirty(); }
+
+    const std::string &header(int series) const { return mSeries[series].header; }
+    void setHeader(int series, const std::string &header) { mSeries[series].header = header; markDirty(); }
+
+    const VectorXf &values(int series) const { return mSeries[series].values; }
+    /// Mutable access to the plotted values (call \ref markDirty() after modifying them)
+    VectorXf &values(int series) { return mSeries[series].values; }
+    void setValues(int series, const VectorXf &values) { mSeries[series].values = values; markDirty(); }
+
+    /// Return the number of cells per row
+    int columns() const { return mColumns; }
+    /// Set the number of cells per row
+    void setColumns(int columns) { mColumns = std::max(columns, 1); invalidatePreferredSize(); }
+
+    /// Return the size of each cell
+    const Vector2i &cellSize() const { return mCellSize; }
+    /// Set the size of each cell
+    void setCellSize(const Vector2i &cellSize) { mCellSize = cellSize; invalidatePreferredSize(); }
+
+    /// Return the spacing between cells
+    int spacing() const { return mSpacing; }
+    /// Set the spacing between cells
+    void setSpacing(int spacing) { mSpacing = spacing; invalidatePreferredSize(); }
+
+    const Color &backgroundColor() const { return mBackgroundColor; }
+    void setBackgroundColor(const Color &backgroundColor) { mBackgroundColor = backgroundColor; markDirty(); }
+
+    const Color &foregroundColor() const { return mForegroundColor; }
+    void setForegroundColor(const Color &foregroundColor) { mForegroundColor = foregroundColor; markDirty(); }
+
+    const Color &textColor() const { return mTextColor; }
+    void setTextColor(const Color &textColor) { mTextColor = textColor; markDirty(); }
+
+    /// Return the position of the cell of a series relative to the widget
+    Vector2i cellPosition(int series) const {
+        return Vector2i(series % mColumns, series / mColumns)
+            .cwiseProduct(mCellSize + Vector2i::Constant(mSpacing));
+    }
+
+    virtual Vector2i preferredSize(NVGcontext *ctx) const override;
+    virtual void draw(NVGcontext *ctx) override;
+    virtual void save(Serializer &s) const override;
+    virtual bool load(Serializer &s) override;
+
+protected:
+    /// Add the plot of a series to the current path
+    void addPlot(NVGcontext *ctx, const VectorXf &values, const Vector2f &pos) const;
+
+    /// Draw the captions (or headers) of all cells after a single font setup
+    void drawTexts(NVGcontext *ctx, bool headers) const;
+
+protected:
+    struct Series {
+        std::string caption, header;
+        VectorXf values;
+    };
+
+    std::vector<Series> mSeries;
+    int mColumns;
+    Vector2i mCellSize;
+    int mSpacing;
+    Color mBackgroundColor, mForegroundColor, mTextColor;
+};
+
+NAMESPACE_END(nanogui)
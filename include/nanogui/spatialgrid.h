@@ -0,0 +1,66 @@
+/*
+    nanogui/spatialgrid.h -- Uniform grid over the child widgets of a
+    container, used to accelerate hit testing
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/common.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class SpatialGrid spatialgrid.h nanogui/spatialgrid.h
+ *
+ * \brief Uniform grid keyed on the rectangles of a set of child widgets.
+ *
+ * The bounding box of all children is split into roughly as many cells as
+ * there are children. Each cell stores the indices of the children that
+ * overlap it, so that a point query only needs to inspect a handful of
+ * candidates instead of every child. See \ref Widget::setSpatialIndex().
+ */
+class NANOGUI_EXPORT SpatialGrid {
+public:
+    SpatialGrid();
+
+    /// Rebuild the grid from the current positions and sizes of the given widgets
+    void build(const std::vector<Widget *> &children);
+
+    /**
+     * \brief Collect the widgets that may contain \c p0 or \c p1
+     *
+     * The returned list preserves the order of the \c children argument
+     * (i.e. the drawing order), so that callers can scan it back to front
+     * exactly like the full child list. Pass the same point twice for a
+     * single point query. The returned reference stays valid until the next
+     * call of \ref query().
+     */
+    const std::vector<Widget *> &query(const Vector2i &p0, const Vector2i &p1,
+                                       const std::vector<Widget *> &children);
+
+    /// Return the number of cells along each axis
+    const Vector2i &resolution() const { return mResolution; }
+
+protected:
+    /// Return the cell index containing \c p, or -1 when outside of the grid
+    int cellIndex(const Vector2i &p) const;
+
+protected:
+    Vector2i mOrigin, mCellSize, mResolution;
+    /// Start offsets of each cell in \ref mItems (compressed row storage)
+    std::vector<uint32_t> mCellStart;
+    /// Child indices per cell, in ascending order
+    std::vector<uint32_t> mItems;
+    /// Scratch storage for query results
+    std::vector<Widget *> mResult;
+};
+
+NAMESPACE_END(nanogui)
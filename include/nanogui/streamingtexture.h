@@ -0,0 +1,131 @@
+/*
+    nanogui/streamingtexture.h -- Texture receiving frames from a producer
+    thread through a ring of mapped pixel buffer objects
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/object.h>
+#include <nanogui/opengl.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class StreamingTexture streamingtexture.h nanogui/streamingtexture.h
+ *
+ * \brief 8 bit RGBA texture updated with frames from a producer thread,
+ *        e.g. a camera feed shown by an \ref ImageView.
+ *
+ * Frames are written into a ring of pixel buffer objects that stay mapped
+ * while the producer may fill them, so the producer never calls OpenGL.
+ * \ref update(), called on the thread owning the OpenGL context, starts an
+ * asynchronous transfer of the newest complete frame into a back texture
+ * and guards it with a fence. The two textures are swapped once the fence
+ * has signaled, so the drawing code never waits for a transfer.
+ *
+ * Frames are \a dropped when the producer finds no free buffer or when a
+ * newer frame supersedes them before being uploaded, and \a late when their
+ * transfer was still in progress at the next call of \ref update().
+ *
+ * The producer thread must have stopped before the texture is destroyed.
+ * The screen set via \ref setScreen() is only referenced weakly: whoever
+ * sets it must reset it to \c nullptr before the screen goes away (an
+ * \ref ImageView does so when it is destroyed or bound to another image).
+ */
+class NANOGUI_EXPORT StreamingTexture : public Object {
+public:
+    /// Create a texture of the given size fed through \c buffers pixel buffer objects (requires a current OpenGL context)
+    StreamingTexture(const Vector2i &size, int buffers = 3);
+
+    /// Return the size of the frames in pixels
+    const Vector2i &size() const { return mSize; }
+
+    /**
+     * \brief Redraw the given screen whenever a frame is complete (or stop
+     * doing so when \c screen is \c nullptr)
+     *
+     * Waits for a redraw requested by the producer that is in progress, so
+     * that the previous screen may be destroyed as soon as this returns.
+     */
+    void setScreen(Screen *screen);
+
+    /* Producer interface (may be called from one thread other than the OpenGL thread) */
+
+    /**
+     * \brief Return a buffer of <tt>size().prod()</tt> RGBA pixels receiving the next frame
+     *
+     * Returns \c nullptr (and counts the frame as dropped) if no buffer is
+     * available. Otherwise, the frame must be completed with \ref endFrame().
+     */
+    uint8_t *beginFrame();
+
+    /// Publish the frame written to the buffer returned by \ref beginFrame()
+    void endFrame();
+
+    /// Copy a complete frame of <tt>size().prod()</tt> RGBA pixels; returns \c false if it was dropped
+    bool pushFrame(const uint8_t *rgba);
+
+    /* OpenGL thread interface */
+
+    /// Start uploading the newest frame and return the texture with the newest uploaded frame (0 if none)
+    GLuint update();
+
+    /// Check whether a frame is waiting or being uploaded (i.e. a further \ref update() is needed)
+    bool framePending() const;
+
+    /// Return the number of frames published by the producer
+    size_t pushedCount() const { return mPushedCount; }
+    /// Return the number of frames that were never shown
+    size_t droppedCount() const { return mDroppedCount; }
+    /// Return the number of frames whose upload was not finished by the next update
+    size_t lateCount() const { return mLateCount; }
+    /// Return the number of frames that became visible
+    size_t shownCount() const { return mShownCount; }
+
+protected:
+    virtual ~StreamingTexture();
+
+    enum SlotState { Unmapped, Free, Writing, Filled, Uploading };
+
+    struct Slot {
+        GLuint buffer = 0;
+        uint8_t *data = nullptr;
+        std::atomic<int> state { Unmapped };
+        std::atomic<uint64_t> sequence { 0 };
+        GLsync fence = nullptr;
+    };
+
+    /// Map the buffer of a slot and hand it to the producer
+    void map(Slot &slot);
+
+    Vector2i mSize;
+    size_t mBytes;
+    int mSlotCount;
+    std::unique_ptr<Slot[]> mSlots;
+    GLuint mTextures[2];
+    int mFront = -1;
+    int mUploading = -1;
+    bool mUploadLate = false;
+
+    Slot *mWriting = nullptr;
+    std::atomic<uint64_t> mSequence { 0 };
+    std::atomic<size_t> mPushedCount { 0 };
+    std::atomic<size_t> mDroppedCount { 0 };
+    size_t mLateCount = 0;
+    size_t mShownCount = 0;
+    std::mutex mScreenMutex;
+    Screen *mScreen = nullptr;
+};
+
+NAMESPACE_END(nanogui)
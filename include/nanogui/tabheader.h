@@ -32,7 +32,7 @@ class NANOGUI_EXPORT TabHeader : public Widget {
 public:
     TabHeader(Widget *parent, const std::string &font = "sans-bold");
 
-    void setFont(const std::string& font) { mFont = font; }
+    void setFont(const std::string& font) { mFont = font; invalidatePreferredSize(); }
     const std::string& font() const { return mFont; }
     bool overflowing() const { return mOverflowing; }
 
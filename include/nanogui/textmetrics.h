@@ -0,0 +1,134 @@
+/*
+    nanogui/textmetrics.h -- Cached text measurements used by layout and
+    drawing code
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/object.h>
+#include <list>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class TextMetrics textmetrics.h nanogui/textmetrics.h
+ *
+ * \brief Measures text on behalf of widgets and caches the results.
+ *
+ * Widgets query the instance owned by their \ref Theme (\ref
+ * Theme::mTextMetrics) instead of calling \c nvgTextBounds() directly, so
+ * that a string is only measured once as long as its font, size and wrap
+ * width stay the same. The least recently used entries are evicted once
+ * the cache reaches its capacity.
+ *
+ * The default implementation measures text using NanoVG. Subclasses may
+ * override \ref measure() to provide metrics without a NanoVG context, e.g.
+ * to compute layouts without a GPU.
+ */
+class NANOGUI_EXPORT TextMetrics : public Object {
+public:
+    /// Create a text metrics service caching up to \c capacity measurements
+    TextMetrics(size_t capacity = 4096);
+
+    /**
+     * \brief Measure a single line of text
+     *
+     * Returns the horizontal advance of the text (like \c nvgTextBounds()).
+     * When \c bounds is not \c nullptr, it receives the bounding box
+     * <tt>[xmin, ymin, xmax, ymax]</tt> of the text drawn with left/top
+     * alignment at the origin.
+     */
+    float textBounds(NVGcontext *ctx, const std::string &font, float size,
+                     const std::string &text, float *bounds = nullptr) const;
+
+    /**
+     * \brief Measure a paragraph of text wrapped at \c breakRowWidth
+     *
+     * Stores the bounding box <tt>[xmin, ymin, xmax, ymax]</tt> of the text
+     * drawn with left/top alignment at the origin (like \c nvgTextBoxBounds()).
+     */
+    void textBoxBounds(NVGcontext *ctx, const std::string &font, float size,
+                       float breakRowWidth, const std::string &text, float *bounds) const;
+
+    /// Return the maximum number of cached measurements
+    size_t capacity() const { return mCapacity; }
+    /// Set the maximum number of cached measurements
+    void setCapacity(size_t capacity);
+
+    /// Return the number of cached measurements
+    size_t size() const { return mEntries.size(); }
+    /// Discard all cached measurements (e.g. after replacing a font)
+    void clear();
+
+    /// Return the number of queries answered from the cache
+    size_t hits() const { return mHits; }
+    /// Return the number of queries that required a measurement
+    size_t misses() const { return mMisses; }
+
+protected:
+    /**
+     * \brief Measure text without consulting the cache
+     *
+     * A negative \c breakRowWidth denotes a single line of text. Returns the
+     * horizontal advance and stores the bounding box into \c bounds.
+     */
+    virtual float measure(NVGcontext *ctx, const std::string &font, float size,
+                          float breakRowWidth, const std::string &text,
+                          float *bounds) const;
+
+    /// Return the cached measurement for the given key, measuring it if needed
+    const float *lookup(NVGcontext *ctx, const std::string &font, float size,
+                        float breakRowWidth, const std::string &text) const;
+
+protected:
+    /**
+     * Parameters of a measurement along with their hash. The strings are
+     * referenced rather than copied, so that probing the cache does not
+     * allocate: keys in the index refer to the strings of their entry.
+     */
+    struct Key {
+        const std::string *font;
+        float size;
+        float breakRowWidth;
+        const std::string *text;
+        size_t hash;
+
+        Key(const std::string &font, float size, float breakRowWidth,
+            const std::string &text);
+
+        bool operator==(const Key &k) const {
+            return hash == k.hash && size == k.size && breakRowWidth == k.breakRowWidth &&
+                   *font == *k.font && *text == *k.text;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key &k) const { return k.hash; }
+    };
+
+    struct Entry {
+        std::string font, text;
+        float size, breakRowWidth;
+        /// Horizontal advance followed by the bounding box
+        float values[5];
+
+        Key key() const { return Key(font, size, breakRowWidth, text); }
+    };
+
+    /// Cached measurements, most recently used first
+    mutable std::list<Entry> mEntries;
+    mutable std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mIndex;
+    size_t mCapacity;
+    mutable size_t mHits, mMisses;
+};
+
+NAMESPACE_END(nanogui)
@@ -16,6 +16,7 @@
 
 #include <nanogui/common.h>
 #include <nanogui/object.h>
+#include <nanogui/textmetrics.h>
 
 NAMESPACE_BEGIN(nanogui)
 
@@ -33,6 +34,9 @@ public:
     int mFontBold;
     int mFontIcons;
 
+    /* Cached text measurements used by the widgets */
+    ref<TextMetrics> mTextMetrics;
+
     /* Spacing-related parameters */
     int mStandardFontSize;
     int mButtonFontSize;
@@ -0,0 +1,167 @@
+/*
+    nanogui/tiledimage.h -- Tiled, mipmapped image sources and the GPU
+    tile cache used by ImageView to display very large images
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+/** \file */
+
+#pragma once
+
+#include <nanogui/object.h>
+#include <nanogui/opengl.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+NAMESPACE_BEGIN(nanogui)
+
+/**
+ * \class TiledImageSource tiledimage.h nanogui/tiledimage.h
+ *
+ * \brief Basic interface of an image that is loaded in square tiles, on
+ *        demand, from a pyramid of mipmap levels.
+ *
+ * Level 0 is the full resolution image, and each following level halves
+ * the resolution (rounding up) until the whole image fits into one tile.
+ * Tile <tt>(x, y)</tt> of level \c l covers the level 0 pixels starting at
+ * <tt>(x, y) * (tileSize() << l)</tt>.
+ *
+ * \ref loadTile() is called from the loader threads of a \ref TileCache and
+ * must therefore be thread-safe.
+ */
+class NANOGUI_EXPORT TiledImageSource : public Object {
+public:
+    /// Return the size of the full resolution image in pixels
+    virtual Vector2i size() const = 0;
+
+    /// Return the width and height of the tiles in pixels
+    virtual int tileSize() const { return 256; }
+
+    /// Return the number of mipmap levels (default: down to a single tile)
+    virtual int levelCount() const;
+
+    /// Return the size of the given mipmap level in pixels
+    Vector2i levelSize(int level) const;
+
+    /// Return the number of tiles along each axis of the given mipmap level
+    Vector2i tileCount(int level) const;
+
+    /**
+     * \brief Load a tile as 8 bit RGBA pixels
+     *
+     * \c rgba holds <tt>tileSize() * tileSize()</tt> zero-initialized pixels
+     * with a row stride of <tt>4 * tileSize()</tt> bytes. Tiles at the right
+     * and bottom edges of a level only need to fill the part that lies
+     * inside the level. Returns \c false if the tile could not be loaded, in
+     * which case it is not requested again.
+     */
+    virtual bool loadTile(int level, const Vector2i &tile, uint8_t *rgba) const = 0;
+
+protected:
+    virtual ~TiledImageSource() { }
+};
+
+/**
+ * \class TileCache tiledimage.h nanogui/tiledimage.h
+ *
+ * \brief Fixed-size cache of image tiles on the GPU.
+ *
+ * Tiles are stored in the layers of one 2D array texture. Requested tiles
+ * are loaded by background threads and uploaded by \ref update() on the
+ * thread owning the OpenGL context. Once all layers are in use, the least
+ * recently used tile that was not drawn in the previous frame is evicted;
+ * loaded tiles wait on the CPU while no tile can be evicted.
+ */
+class NANOGUI_EXPORT TileCache {
+public:
+    /// Create a cache holding up to \c capacity tiles (requires a current OpenGL context)
+    TileCache(TiledImageSource *source, int capacity = 256, int threads = 2);
+    ~TileCache();
+
+    TiledImageSource *source() { return mSource.get(); }
+    const TiledImageSource *source() const { return mSource.get(); }
+
+    /// Return the maximum number of tiles resident on the GPU
+    int capacity() const { return mCapacity; }
+    /// Return the number of tiles resident on the GPU
+    int size() const { return (int) mResident.size(); }
+    /// Return the 2D array texture storing the tiles
+    GLuint texture() const { return mTexture; }
+
+    /// Redraw the given screen whenever a tile has finished loading
+    void setScreen(Screen *screen) { mScreen = screen; }
+
+    /**
+     * \brief Replace the queue of tiles to be loaded, most important first
+     *
+     * Only the first \ref capacity() tiles are considered, since more would
+     * evict each other. Of these, tiles that are resident, loading or
+     * failed to load are skipped, as are repeated entries.
+     */
+    void request(const std::vector<std::pair<int, Vector2i>> &tiles);
+
+    /// Start a new frame and upload the tiles that finished loading since the last call
+    void update();
+
+    /// Return the texture layer of a resident tile (or -1) and mark it as recently used
+    int lookup(int level, const Vector2i &tile);
+
+    /// Return the number of tiles queued, being loaded or waiting for a free layer
+    size_t pendingCount() const;
+    /// Return the number of tiles uploaded to the GPU so far
+    size_t uploadCount() const { return mUploadCount; }
+    /// Return the number of tiles evicted from the GPU so far
+    size_t evictionCount() const { return mEvictionCount; }
+
+protected:
+    struct Entry {
+        int layer;
+        size_t lastUsed;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    static uint64_t key(int level, const Vector2i &tile) {
+        return ((uint64_t) level << 56) | ((uint64_t) tile.y() << 28) | (uint64_t) tile.x();
+    }
+
+    /// Body of the loader threads
+    void run();
+
+    ref<TiledImageSource> mSource;
+    int mCapacity;
+    GLuint mTexture;
+
+    /* State owned by the OpenGL thread */
+    std::unordered_map<uint64_t, Entry> mResident;
+    std::list<uint64_t> mLru;
+    std::vector<int> mFreeLayers;
+    size_t mFrame = 0;
+    size_t mUploadCount = 0;
+    size_t mEvictionCount = 0;
+
+    /* State shared with the loader threads (protected by mMutex) */
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<uint64_t> mQueue;
+    std::unordered_set<uint64_t> mInFlight;
+    std::unordered_set<uint64_t> mFailed;
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> mLoaded;
+    bool mStop = false;
+
+    std::atomic<Screen *> mScreen;
+    std::vector<std::thread> mThreads;
+};
+
+NAMESPACE_END(nanogui)
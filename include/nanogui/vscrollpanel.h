@@ -29,6 +29,17 @@ class NANOGUI_EXPORT VScrollPanel : public Widget {
 public:
     VScrollPanel(Widget *parent);
 
+    /// Return the scroll offset of the child widget in pixels
+    float scroll() const { return mScroll; }
+    /**
+     * \brief Set the scroll offset of the child widget in pixels
+     *
+     * The offset is clamped to the scrollable range. Scrolling only moves the
+     * child widget; it is laid out again only when its contents or the size
+     * of the panel change.
+     */
+    void setScroll(float scroll);
+
     virtual void performLayout(NVGcontext *ctx) override;
     virtual Vector2i preferredSize(NVGcontext *ctx) const override;
     virtual bool mouseDragEvent(const Vector2i &p, const Vector2i &rel, int button, int modifiers) override;
@@ -39,6 +50,7 @@ public:
 
 protected:
     int mChildPreferredHeight;
+    /// Scroll offset in pixels, kept when the height of the child changes
     float mScroll;
 };
 
@@ -49,7 +49,7 @@ public:
     /// Return the used \ref Layout generator
     const Layout *layout() const { return mLayout.get(); }
     /// Set the used \ref Layout generator
-    void setLayout(Layout *layout) { mLayout = layout; }
+    void setLayout(Layout *layout) { mLayout = layout; invalidatePreferredSize(); }
 
     /// Return the \ref Theme used to draw this widget
     Theme *theme() { return mTheme; }
@@ -61,7 +61,7 @@ public:
     /// Return the position relative to the parent widget
     const Vector2i &position() const { return mPos; }
     /// Set the position relative to the parent widget
-    void setPosition(const Vector2i &pos) { mPos = pos; }
+    void setPosition(const Vector2i &pos) { mPos = pos; invalidateParentIndex(); }
 
     /// Return the absolute position on screen
     Vector2i absolutePosition() const {
@@ -72,17 +72,23 @@ public:
     /// Return the size of the widget
     const Vector2i &size() const { return mSize; }
     /// set the size of the widget
-    void setSize(const Vector2i &size) { mSize = size; }
+    void setSize(const Vector2i &size) {
+        if (size != mSize) {
+            mSize = size;
+            invalidateParentIndex();
+            invalidatePreferredSize();
+        }
+    }
 
     /// Return the width of the widget
     int width() const { return mSize.x(); }
     /// Set the width of the widget
-    void setWidth(int width) { mSize.x() = width; }
+    void setWidth(int width) { setSize(Vector2i(width, mSize.y())); }
 
     /// Return the height of the widget
     int height() const { return mSize.y(); }
     /// Set the height of the widget
-    void setHeight(int height) { mSize.y() = height; }
+    void setHeight(int height) { setSize(Vector2i(mSize.x(), height)); }
 
     /**
      * \brief Set the fixed size of this widget
@@ -93,7 +99,7 @@ public:
      * size; this is done with a call to \ref setSize or a call to \ref performLayout()
      * in the parent widget.
      */
-    void setFixedSize(const Vector2i &fixedSize) { mFixedSize = fixedSize; }
+    void setFixedSize(const Vector2i &fixedSize) { mFixedSize = fixedSize; invalidateParentLayout(); }
 
     /// Return the fixed size (see \ref setFixedSize())
     const Vector2i &fixedSize() const { return mFixedSize; }
@@ -103,14 +109,20 @@ public:
     // Return the fixed height (see \ref setFixedSize())
     int fixedHeight() const { return mFixedSize.y(); }
     /// Set the fixed width (see \ref setFixedSize())
-    void setFixedWidth(int width) { mFixedSize.x() = width; }
+    void setFixedWidth(int width) { mFixedSize.x() = width; invalidateParentLayout(); }
     /// Set the fixed height (see \ref setFixedSize())
-    void setFixedHeight(int height) { mFixedSize.y() = height; }
+    void setFixedHeight(int height) { mFixedSize.y() = height; invalidateParentLayout(); }
 
     /// Return whether or not the widget is currently visible (assuming all parents are visible)
     bool visible() const { return mVisible; }
     /// Set whether or not the widget is currently visible (assuming all parents are visible)
-    void setVisible(bool visible) { mVisible = visible; }
+    void setVisible(bool visible) {
+        if (visible != mVisible) {
+            mVisible = visible;
+            invalidateParentLayout();
+            markDirty();
+        }
+    }
 
     /// Check if this widget is currently visible, taking parent widgets into account
     bool visibleRecursive() const {
@@ -125,9 +137,9 @@ public:
     /// Query the status of 'show border'
     bool showBorder() const {return mShowBorder;}
     /// Turn on of off the border around this widget
-    void setShowBorder(bool show) {mShowBorder = show;}
+    void setShowBorder(bool show) {mShowBorder = show; markDirty();}
     /// Set the color of the border
-    void setBorderColor(Color bdrcol) {mBorderColor = bdrcol;}
+    void setBorderColor(Color bdrcol) {mBorderColor = bdrcol; markDirty();}
     /// Get the color of the border
     Color borderColor() const {return mBorderColor;}
 
@@ -185,7 +197,7 @@ public:
     /// Return whether or not this widget is currently enabled
     bool enabled() const { return mEnabled; }
     /// Set whether or not this widget is currently enabled
-    void setEnabled(bool enabled) { mEnabled = enabled; }
+    void setEnabled(bool enabled) { mEnabled = enabled; markDirty(); }
 
     /// Return whether or not this widget is currently focused
     bool focused() const { return mFocused; }
@@ -194,13 +206,24 @@ public:
     /// Request the focus to be moved to this widget
     void requestFocus();
 
+    /**
+     * \brief Notify the parent \ref Screen that this widget's appearance changed
+     *
+     * The main loop only redraws a screen when some widget inside it has been
+     * marked as dirty (or when input events arrive). Widgets call this from
+     * their own setters; application code only needs to call it after
+     * modifying widget state through a mutable accessor or when drawing
+     * animated content.
+     */
+    void markDirty();
+
     const std::string &tooltip() const { return mTooltip; }
     void setTooltip(const std::string &tooltip) { mTooltip = tooltip; }
 
     /// Return current font size. If not set the default of the current theme will be returned
     int fontSize() const;
     /// Set the font size of this widget
-    void setFontSize(int fontSize) { mFontSize = fontSize; }
+    void setFontSize(int fontSize) { mFontSize = fontSize; invalidatePreferredSize(); markDirty(); }
     /// Return whether the font size is explicitly specified for this widget
     bool hasFontSize() const { return mFontSize > 0; }
 
@@ -218,6 +241,20 @@ public:
     /// Determine the widget located at the given position value (recursive)
     Widget *findWidget(const Vector2i &p);
 
+    /**
+     * \brief Enable or disable a spatial index over the child widgets
+     *
+     * Containers with a large number of children can use a uniform grid
+     * keyed on the child rectangles (see \ref SpatialGrid) to accelerate
+     * \ref findWidget() and the default mouse and scroll event dispatch.
+     * The index is rebuilt lazily on the next query after children were
+     * added, removed, moved or resized (e.g. by \ref performLayout()).
+     */
+    void setSpatialIndex(bool enabled);
+
+    /// Return whether hit testing among the children uses a spatial index
+    bool hasSpatialIndex() const { return mSpatialIndex != nullptr; }
+
     /// Handle a mouse button event (default implementation: propagate to children)
     virtual bool mouseButtonEvent(const Vector2i &p, int button, bool down, int modifiers);
 
@@ -245,6 +282,58 @@ public:
     /// Compute the preferred size of the widget
     virtual Vector2i preferredSize(NVGcontext *ctx) const;
 
+    /**
+     * \brief Return the preferred size of the widget, computing it only if needed
+     *
+     * Layout generators query child widgets through this function, so that
+     * each widget's \ref preferredSize() is evaluated once per layout pass
+     * instead of once per level of nesting. The cached value is discarded by
+     * \ref invalidatePreferredSize().
+     */
+    Vector2i cachedPreferredSize(NVGcontext *ctx) const;
+
+    /**
+     * \brief Enable or disable the cache of \ref cachedPreferredSize() for
+     * all widgets (enabled by default)
+     *
+     * Without the cache, every query evaluates \ref preferredSize() again.
+     * This is only meant for comparing layout performance with and without it.
+     */
+    static void setPreferredSizeCaching(bool enabled);
+    /// Return whether \ref cachedPreferredSize() caches its results
+    static bool preferredSizeCaching();
+
+    /**
+     * \brief Discard the cached preferred size of this widget and of all its
+     * ancestors
+     *
+     * The standard setters (caption, font, fixed size, visibility, children,
+     * layout, ..) call this automatically. Call it by hand after changing
+     * anything else that affects \ref preferredSize(), such as the
+     * parameters of a \ref Layout that is already in use.
+     *
+     * This also schedules a new layout of the nearest ancestor whose size
+     * does not depend on its contents (see \ref markLayoutDirty()).
+     */
+    void invalidatePreferredSize();
+
+    /**
+     * \brief Schedule a new layout of this widget before the next frame
+     *
+     * The \ref Screen calls \ref performLayout() on all widgets marked in
+     * this way before drawing, instead of laying out the whole hierarchy.
+     * When the size or the preferred size of a widget changes, its nearest
+     * ancestor with a fixed size (or the top-level window containing it) is
+     * marked automatically, which lays out the widget along with its
+     * siblings. Top-level windows
+     * keep their current size; use \ref Screen::performLayout() to fit them
+     * to their contents.
+     */
+    void markLayoutDirty();
+
+    /// Return whether this widget is scheduled for a new layout
+    bool layoutDirty() const { return mLayoutDirty; }
+
     /// Invoke the associated layout generator to properly place child widgets, if any
     virtual void performLayout(NVGcontext *ctx);
 
@@ -261,6 +350,33 @@ protected:
     /// Free all resources used by the widget and any children
     virtual ~Widget();
 
+    /// Mark the spatial index of the parent as stale after a change of position or size
+    void invalidateParentIndex() {
+        if (mParent)
+            mParent->mSpatialIndexValid = false;
+    }
+
+    /// Discard cached preferred sizes after a change that affects the layout of the parent
+    void invalidateParentLayout() {
+        invalidatePreferredSize();
+        if (mParent)
+            mParent->invalidatePreferredSize();
+    }
+
+    /// Collect the topmost widgets in this subtree that were marked by \ref markLayoutDirty()
+    void collectLayoutRoots(std::vector<Widget *> &roots);
+
+    /// Clear the layout flags set by \ref markLayoutDirty() in this subtree
+    void clearLayoutDirty();
+
+    /**
+     * \brief Return the children that may contain \c p0 or \c p1 (given
+     * relative to this widget), in drawing order
+     *
+     * Without a spatial index, this is simply the list of all children.
+     */
+    const std::vector<Widget *> &hitCandidates(const Vector2i &p0, const Vector2i &p1);
+
 protected:
     Widget *mParent;
     ref<Theme> mTheme;
@@ -268,6 +384,11 @@ protected:
     std::string mId;
     Vector2i mPos, mSize, mFixedSize;
     std::vector<Widget *> mChildren;
+    SpatialGrid *mSpatialIndex;
+    bool mSpatialIndexValid;
+    mutable Vector2i mPreferredSize;
+    mutable bool mPreferredSizeValid;
+    bool mLayoutDirty, mLayoutPending;
     bool mVisible, mEnabled;
     bool mFocused, mMouseFocus;
     bool mShowBorder;
@@ -29,7 +29,7 @@ public:
     /// Return the window title
     const std::string &title() const { return mTitle; }
     /// Set the window title
-    void setTitle(const std::string &title) { mTitle = title; }
+    void setTitle(const std::string &title) { mTitle = title; invalidatePreferredSize(); markDirty(); }
 
     /// Is this a model dialog?
     bool modal() const { return mModal; }
@@ -45,7 +45,7 @@ public:
     /// Center the window in the current \ref Screen
     void center();
     ///Maximizes the window to the screen size during layout
-    void setMaximized(bool maximize) {mMaximized = maximize;};
+    void setMaximized(bool maximize) {mMaximized = maximize; invalidatePreferredSize();};
     /// Returns true if the window is maximized
     bool maximized() const {return mMaximized;}
 
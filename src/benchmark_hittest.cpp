@@ -0,0 +1,62 @@
+/*
+    src/benchmark_hittest.cpp -- Measures the cost of hit testing a
+    container against its number of children, with and without the
+    spatial index enabled by Widget::setSpatialIndex()
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/widget.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace nanogui;
+
+int main(int /* argc */, char ** /* argv */) {
+    const int extent = 2000, queries = 100000;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int> coordinate(0, extent - 1), width(10, 40);
+
+    std::vector<Vector2i> points(queries);
+    for (auto &p : points)
+        p = Vector2i(coordinate(rng), coordinate(rng));
+
+    printf("%8s %18s %18s %8s\n", "children", "linear scan", "spatial index", "speedup");
+    for (int childCount : { 100, 1000, 10000, 50000 }) {
+        ref<Widget> container = new Widget(nullptr);
+        container->setSize(Vector2i::Constant(extent));
+        for (int i = 0; i < childCount; ++i) {
+            Widget *child = new Widget(container);
+            child->setPosition(Vector2i(coordinate(rng), coordinate(rng)));
+            child->setSize(Vector2i(width(rng), width(rng)));
+        }
+
+        double time[2];
+        uintptr_t checksum[2];
+        for (int indexed = 0; indexed < 2; ++indexed) {
+            container->setSpatialIndex(indexed == 1);
+            container->findWidget(points[0]); /* Build the index outside of the timed loop */
+            checksum[indexed] = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto &p : points)
+                checksum[indexed] += (uintptr_t) container->findWidget(p);
+            auto end = std::chrono::steady_clock::now();
+            time[indexed] = std::chrono::duration<double, std::micro>(end - start).count() / queries;
+        }
+        if (checksum[0] != checksum[1]) {
+            fprintf(stderr, "The spatial index found different widgets!\n");
+            return -1;
+        }
+        printf("%8d %15.3f us %15.3f us %7.1fx\n", childCount, time[0], time[1], time[0] / time[1]);
+    }
+
+    return 0;
+}
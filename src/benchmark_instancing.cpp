@@ -0,0 +1,146 @@
+/*
+    src/benchmark_instancing.cpp -- Compares drawing many small quads with
+    one draw call each against instanced and batched draw calls
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/opengl.h>
+#include <nanogui/glutil.h>
+#include <nanogui/screen.h>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace nanogui;
+
+int main(int /* argc */, char ** /* argv */) {
+    const int size = 512, frames = 10;
+
+    try {
+#if !defined(NANOGUI_HEADLESS)
+        nanogui::init();
+#endif
+
+        {
+            /* The screen only provides the OpenGL context (without a window or
+               display server when possible), drawing goes to a framebuffer */
+#if defined(NANOGUI_HEADLESS)
+            ref<Screen> screen = new Screen(Vector2i(size, size), 1.f);
+#else
+            ref<Screen> screen = new Screen(Vector2i(size, size), "Instancing benchmark", false);
+#endif
+            GLFramebuffer framebuffer;
+            framebuffer.init(Vector2i(size, size), 1);
+            framebuffer.bind();
+            glViewport(0, 0, size, size);
+
+            printf("OpenGL %s, batched draw calls %s\n", (const char *) glGetString(GL_VERSION),
+                   GLShader::multiDrawIndirectSupported() ? "indirect" : "emulated");
+
+            const char *fragmentShader =
+                "#version 330\n"
+                "out vec4 color;\n"
+                "void main() {\n"
+                "    color = vec4(1.0);\n"
+                "}";
+
+            GLShader single, instanced, batched;
+            single.init("single",
+                "#version 330\n"
+                "uniform vec2 offset;\n"
+                "in vec2 corner;\n"
+                "void main() {\n"
+                "    gl_Position = vec4(offset + corner * 0.002, 0.0, 1.0);\n"
+                "}", fragmentShader);
+            instanced.init("instanced",
+                "#version 330\n"
+                "in vec2 offset;\n"
+                "in vec2 corner;\n"
+                "void main() {\n"
+                "    gl_Position = vec4(offset + corner * 0.002, 0.0, 1.0);\n"
+                "}", fragmentShader);
+            batched.init("batched",
+                "#version 330\n"
+                "in vec2 position;\n"
+                "void main() {\n"
+                "    gl_Position = vec4(position, 0.0, 1.0);\n"
+                "}", fragmentShader);
+
+            MatrixXf corners(2, 4);
+            corners << -1, 1, -1, 1,
+                       -1, -1, 1, 1;
+
+            printf("%8s %-22s %8s %12s\n", "quads", "method", "calls", "time");
+            for (int count : { 1000, 10000, 50000 }) {
+                MatrixXf offsets = MatrixXf::Random(2, count) * 0.95f;
+                MatrixXf positions(2, 4 * count);
+                std::vector<DrawArrayCommand> commands(count);
+                for (int i = 0; i < count; ++i) {
+                    for (int c = 0; c < 4; ++c)
+                        positions.col(4 * i + c) = offsets.col(i) + corners.col(c) * 0.002f;
+                    commands[i] = DrawArrayCommand { 4, 1, (uint32_t) (4 * i), 0 };
+                }
+
+                single.bind();
+                single.uploadAttrib("corner", corners);
+                instanced.bind();
+                instanced.uploadAttrib("corner", corners);
+                instanced.uploadAttrib("offset", offsets);
+                instanced.setAttribDivisor("offset", 1);
+                batched.bind();
+                batched.uploadAttrib("position", positions);
+
+                const char *names[] = { "drawArray per quad", "drawArrayInstanced", "multiDrawArray" };
+                for (int method = 0; method < 3; ++method) {
+                    glFinish();
+                    auto start = std::chrono::steady_clock::now();
+                    for (int frame = 0; frame < frames; ++frame) {
+                        glClear(GL_COLOR_BUFFER_BIT);
+                        if (method == 0) {
+                            single.bind();
+                            UniformHandle offset = single.uniformHandle("offset");
+                            for (int i = 0; i < count; ++i) {
+                                single.setUniform(offset, Vector2f(offsets.col(i)));
+                                single.drawArray(GL_TRIANGLE_STRIP, 0, 4);
+                            }
+                        } else if (method == 1) {
+                            instanced.bind();
+                            instanced.drawArrayInstanced(GL_TRIANGLE_STRIP, 0, 4, count);
+                        } else {
+                            batched.bind();
+                            batched.multiDrawArray(GL_TRIANGLE_STRIP, commands);
+                        }
+                        glFinish();
+                    }
+                    auto end = std::chrono::steady_clock::now();
+                    double time = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+                    printf("%8d %-22s %8d %9.2f ms\n", count, names[method],
+                           method == 0 ? count : 1, time);
+                }
+            }
+
+            single.free();
+            instanced.free();
+            batched.free();
+            framebuffer.free();
+        }
+
+#if !defined(NANOGUI_HEADLESS)
+        nanogui::shutdown();
+#endif
+    } catch (const std::runtime_error &e) {
+        std::string error_msg = std::string("Caught a fatal error: ") + std::string(e.what());
+        fprintf(stderr, "%s\n", error_msg.c_str());
+        return -1;
+    }
+
+    return 0;
+}
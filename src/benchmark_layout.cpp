@@ -0,0 +1,98 @@
+/*
+    src/benchmark_layout.cpp -- Measures layout passes over a deep tree of
+    nested windows, which are linear in the number of widgets thanks to
+    the cached preferred sizes (and quadratic in the depth without them)
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/screen.h>
+#include <nanogui/window.h>
+#include <nanogui/layout.h>
+#include <nanogui/label.h>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+using namespace nanogui;
+
+typedef std::chrono::steady_clock Clock;
+
+static double milliseconds(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int /* argc */, char ** /* argv */) {
+    const int widgetsPerWindow = 8, repetitions = 20;
+
+    try {
+        nanogui::init();
+
+        printf("%6s %8s %16s %22s %22s %22s\n", "depth", "widgets", "first layout",
+               "performLayout()", "uncached", "updateLayout()");
+        for (int depth : { 25, 50, 100, 200 }) {
+            ref<Screen> screen = new Screen(Vector2i(1024, 768), "Layout benchmark", false);
+
+            /* A chain of nested windows with alternating layouts, each holding a
+               few labels next to the following window */
+            Widget *parent = screen.get();
+            Label *leaf = nullptr;
+            for (int level = 0; level < depth; ++level) {
+                Window *window = new Window(parent, "Level " + std::to_string(level));
+                if (level % 2 == 0)
+                    window->setLayout(new BoxLayout(Orientation::Vertical, Alignment::Fill, 4, 2));
+                else
+                    window->setLayout(new GroupLayout(4, 2, 4, 4));
+                for (int i = 0; i < widgetsPerWindow; ++i)
+                    leaf = new Label(window, "Label " + std::to_string(i));
+                parent = window;
+            }
+
+            auto start = Clock::now();
+            screen->performLayout();
+            double first = milliseconds(start);
+
+            /* Relayout after changing the caption of the deepest label, which
+               invalidates the preferred size of every enclosing window. The
+               uncached pass evaluates every preferred size once per enclosing
+               window, as layouts did before the cache was introduced */
+            double full = 0, uncached = 0, incremental = 0;
+            for (int i = 0; i < repetitions; ++i) {
+                leaf->setCaption("Caption " + std::to_string(3 * i));
+                start = Clock::now();
+                screen->performLayout();
+                full += milliseconds(start);
+
+                Widget::setPreferredSizeCaching(false);
+                leaf->setCaption("Caption " + std::to_string(3 * i + 1));
+                start = Clock::now();
+                screen->performLayout();
+                uncached += milliseconds(start);
+                Widget::setPreferredSizeCaching(true);
+
+                leaf->setCaption("Caption " + std::to_string(3 * i + 2));
+                start = Clock::now();
+                screen->updateLayout();
+                incremental += milliseconds(start);
+            }
+
+            printf("%6d %8d %13.3f ms %19.3f ms %19.3f ms %19.3f ms\n", depth,
+                   depth * (widgetsPerWindow + 1), first, full / repetitions,
+                   uncached / repetitions, incremental / repetitions);
+        }
+
+        nanogui::shutdown();
+    } catch (const std::runtime_error &e) {
+        std::string error_msg = std::string("Caught a fatal error: ") + std::string(e.what());
+        fprintf(stderr, "%s\n", error_msg.c_str());
+        return -1;
+    }
+
+    return 0;
+}
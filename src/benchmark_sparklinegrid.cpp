@@ -0,0 +1,93 @@
+/*
+    src/benchmark_sparklinegrid.cpp -- Compares the frame time of 400
+    Graph widgets against a single SparklineGrid showing the same series
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/opengl.h>
+#include <nanogui/screen.h>
+#include <nanogui/layout.h>
+#include <nanogui/graph.h>
+#include <nanogui/sparklinegrid.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+using namespace nanogui;
+
+/// Return the average time of a frame in milliseconds
+static double timeFrames(Screen *screen, int frames) {
+    for (int i = 0; i < 10; ++i)
+        screen->drawAll();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i)
+        screen->drawAll();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+int main(int /* argc */, char ** /* argv */) {
+    const int seriesCount = 400, sampleCount = 200, columns = 20, frames = 200;
+    const Vector2i cellSize(60, 24);
+
+    try {
+        nanogui::init();
+
+        {
+            Screen *screen = new Screen(Vector2i(1300, 600), "SparklineGrid benchmark", false);
+            glfwSwapInterval(0);
+
+            Widget *graphs = new Widget(screen);
+            graphs->setLayout(new GridLayout(Orientation::Horizontal, columns, Alignment::Fill, 0, 4));
+            SparklineGrid *grid = new SparklineGrid(screen);
+            grid->setColumns(columns);
+            grid->setCellSize(cellSize);
+
+            for (int i = 0; i < seriesCount; ++i) {
+                VectorXf values(sampleCount);
+                for (int j = 0; j < sampleCount; ++j)
+                    values[j] = 0.5f + 0.4f * std::sin(0.1f * j + i);
+                std::string caption = "Series " + std::to_string(i);
+
+                Graph *graph = new Graph(graphs, caption);
+                graph->setFixedSize(cellSize);
+                graph->setValues(values);
+                graph->setHeader("12.3 ms");
+                graph->setFooter("");
+
+                int series = grid->addSeries(caption);
+                grid->setValues(series, values);
+                grid->setHeader(series, "12.3 ms");
+            }
+
+            screen->setVisible(true);
+            screen->performLayout();
+
+            grid->setVisible(false);
+            double graphTime = timeFrames(screen, frames);
+            graphs->setVisible(false);
+            grid->setVisible(true);
+            double gridTime = timeFrames(screen, frames);
+
+            printf("%d series of %d samples, %d frames each:\n", seriesCount, sampleCount, frames);
+            printf("  %d Graphs:     %.3f ms/frame\n", seriesCount, graphTime);
+            printf("  SparklineGrid: %.3f ms/frame\n", gridTime);
+        }
+
+        nanogui::shutdown();
+    } catch (const std::runtime_error &e) {
+        std::string error_msg = std::string("Caught a fatal error: ") + std::string(e.what());
+        fprintf(stderr, "%s\n", error_msg.c_str());
+        return -1;
+    }
+
+    return 0;
+}
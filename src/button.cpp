@@ -24,17 +24,14 @@ Button::Button(Widget *parent, const std::string &caption, int icon)
 
 Vector2i Button::preferredSize(NVGcontext *ctx) const {
     int fontSize = mFontSize == -1 ? mTheme->mButtonFontSize : mFontSize;
-    nvgFontSize(ctx, fontSize);
-    nvgFontFace(ctx, "sans-bold");
-    float tw = nvgTextBounds(ctx, 0,0, mCaption.c_str(), nullptr, nullptr);
+    const TextMetrics *metrics = mTheme->mTextMetrics.get();
+    float tw = metrics->textBounds(ctx, "sans-bold", fontSize, mCaption);
     float iw = 0.0f, ih = fontSize;
 
     if (mIcon) {
         if (nvgIsFontIcon(mIcon)) {
             ih *= 1.5f;
-            nvgFontFace(ctx, "icons");
-            nvgFontSize(ctx, ih);
-            iw = nvgTextBounds(ctx, 0, 0, utf8(mIcon).data(), nullptr, nullptr)
+            iw = metrics->textBounds(ctx, "icons", ih, utf8(mIcon).data())
                 + mSize.y() * 0.15f;
         } else {
             int w, h;
@@ -155,7 +152,7 @@ void Button::draw(NVGcontext *ctx) {
     int fontSize = mFontSize == -1 ? mTheme->mButtonFontSize : mFontSize;
     nvgFontSize(ctx, fontSize);
     nvgFontFace(ctx, "sans-bold");
-    float tw = nvgTextBounds(ctx, 0,0, mCaption.c_str(), nullptr, nullptr);
+    float tw = mTheme->mTextMetrics->textBounds(ctx, "sans-bold", fontSize, mCaption);
 
     Vector2f center = mPos.cast<float>() + mSize.cast<float>() * 0.5f;
     Vector2f textPos(center.x() - tw * 0.5f, center.y() - 1);
@@ -172,7 +169,7 @@ void Button::draw(NVGcontext *ctx) {
             ih *= 1.5f;
             nvgFontSize(ctx, ih);
             nvgFontFace(ctx, "icons");
-            iw = nvgTextBounds(ctx, 0, 0, icon.data(), nullptr, nullptr);
+            iw = mTheme->mTextMetrics->textBounds(ctx, "icons", ih, icon.data());
         } else {
             int w, h;
             ih *= 0.9f;
@@ -47,10 +47,8 @@ bool CheckBox::mouseButtonEvent(const Vector2i &p, int button, bool down,
 Vector2i CheckBox::preferredSize(NVGcontext *ctx) const {
     if (mFixedSize != Vector2i::Zero())
         return mFixedSize;
-    nvgFontSize(ctx, fontSize());
-    nvgFontFace(ctx, "sans");
     return Vector2i(
-        nvgTextBounds(ctx, 0, 0, mCaption.c_str(), nullptr, nullptr) +
+        mTheme->mTextMetrics->textBounds(ctx, "sans", fontSize(), mCaption) +
             1.8f * fontSize(),
         fontSize() * 1.3f);
 }
@@ -61,10 +61,10 @@ void mainloop(int refresh) {
 
     std::thread refresh_thread;
     if (refresh > 0) {
-        /* If there are no mouse/keyboard events, try to refresh the
-           view roughly every 50 ms (default); this is to support animations
-           such as progress bars while keeping the system load
-           reasonably low */
+        /* If there are no mouse/keyboard events, wake up roughly every
+           50 ms (default) and redraw screens containing dirty widgets; this
+           is to support animations such as progress bars while keeping the
+           system load reasonably low */
         refresh_thread = std::thread(
             [refresh]() {
                 std::chrono::milliseconds time(refresh);
@@ -87,8 +87,14 @@ void mainloop(int refresh) {
                     screen->setVisible(false);
                     continue;
                 }
-                screen->drawAll();
                 numScreens++;
+
+                /* Skip screens where nothing has changed since the last frame */
+                if (!screen->mRedraw) {
+                    screen->mSkippedFrames++;
+                    continue;
+                }
+                screen->drawAll();
             }
 
             if (numScreens == 0) {
@@ -570,6 +570,9 @@ public:
 
         /* Draw 2 triangles starting at index 0 */
         mShader.drawIndexed(GL_TRIANGLES, 0, 2);
+
+        /* Keep the quad spinning */
+        redraw();
     }
 private:
     nanogui::ProgressBar *mProgress;
@@ -172,6 +172,9 @@ public:
         /* Draw 12 triangles starting at index 0 */
         mShader.drawIndexed(GL_TRIANGLES, 0, 12);
         glDisable(GL_DEPTH_TEST);
+
+        /* Keep the cube spinning */
+        markDirty();
     }
 
 private:
@@ -12,14 +12,91 @@
 #include <nanogui/glutil.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <Eigen/Geometry>
 
 #if defined(_WIN32) && defined(__GNUC__)
 #   include <malloc.h> //for 'alloca' in Win32 with MinGW GCC
 #endif // defined
 
+#if defined(NANOGUI_HEADLESS)
+#  include <EGL/egl.h>
+#endif
+
+#if defined(_WIN32)
+#  include <direct.h>
+#else
+#  include <sys/stat.h>
+#endif
+
 NAMESPACE_BEGIN(nanogui)
 
+/* Registry of programs shared between GLShader instances (see GLShader::initShared) */
+struct SharedBuffer {
+    GLuint id;
+    GLuint glType;
+    int dim;
+    bool integral;
+};
+
+struct SharedProgram {
+    GLuint program;
+    size_t refCount;
+    std::map<std::string, SharedBuffer> buffers;
+    std::shared_ptr<void> locations;
+};
+
+static std::map<std::string, SharedProgram> __nanogui_shared_programs;
+
+/* Number of bytes transferred to vertex and index buffers (see GLShader::uploadedBytes) */
+static size_t __nanogui_uploaded_bytes = 0;
+
+/* Program binary cache (see GLShader::setProgramCacheDirectory) */
+static std::string __nanogui_program_cache_directory;
+static GLShader::ProgramCacheStatistics __nanogui_program_cache_statistics;
+static bool __nanogui_program_cache_verbose = false;
+
+/* Identify the current OpenGL context, since objects are not shared between the contexts of different screens */
+static const void *current_context_helper() {
+    const void *context = glfwGetCurrentContext();
+#if defined(NANOGUI_HEADLESS)
+    if (!context)
+        context = eglGetCurrentContext();
+#endif
+    return context;
+}
+
+/* Check whether the current context provides a given OpenGL version or extension */
+static bool has_feature_helper(int major, int minor, const char *name) {
+    GLint contextMajor = 0, contextMinor = 0, extensions = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    if (contextMajor > major || (contextMajor == major && contextMinor >= minor))
+        return true;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; ++i) {
+        const char *extension = (const char *) glGetStringi(GL_EXTENSIONS, (GLuint) i);
+        if (extension && strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+/* Feature support detected per OpenGL context (see context_feature_helper) */
+static std::map<std::pair<const void *, std::string>, bool> __nanogui_context_features;
+
+/* Return whether the current context supports a feature, calling 'detect' only once per context */
+template <typename Detect>
+static bool context_feature_helper(const char *name, const Detect &detect) {
+    auto key = std::make_pair(current_context_helper(), std::string(name));
+    auto it = __nanogui_context_features.find(key);
+    if (it == __nanogui_context_features.end())
+        it = __nanogui_context_features.insert(std::make_pair(key, (bool) detect())).first;
+    return it->second;
+}
+
 static GLuint createShader_helper(GLint type, const std::string &name,
                                   const std::string &defines,
                                   std::string shader_string) {
@@ -88,6 +165,272 @@ bool GLShader::initFromFiles(
                 file_to_string(geometry_fname));
 }
 
+static GLuint createProgram_helper(const std::string &name, GLuint vertexShader,
+                                   GLuint fragmentShader, GLuint geometryShader,
+                                   bool retrievable = false) {
+    GLuint program = glCreateProgram();
+#if defined(GL_VERSION_4_1)
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+#else
+    (void) retrievable;
+#endif
+
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+
+    if (geometryShader)
+        glAttachShader(program, geometryShader);
+
+    glLinkProgram(program);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+    if (status != GL_TRUE) {
+        char buffer[512];
+        glGetProgramInfoLog(program, 512, nullptr, buffer);
+        std::cerr << "Linker error (" << name << "): " << std::endl << buffer << std::endl;
+        glDeleteProgram(program);
+        throw std::runtime_error("Shader linking failed!");
+    }
+
+    return program;
+}
+
+/* Stable 64 bit FNV-1a hash naming the files of the program binary cache */
+static uint64_t hash_helper(const std::string &str) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : str) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/* Create a directory and its parents, ignoring those that already exist */
+static void createDirectory_helper(const std::string &path) {
+    for (size_t i = 1; i <= path.length(); ++i) {
+        if (i < path.length() && path[i] != '/' && path[i] != '\\')
+            continue;
+        std::string prefix = path.substr(0, i);
+#if defined(_WIN32)
+        _mkdir(prefix.c_str());
+#else
+        mkdir(prefix.c_str(), 0755);
+#endif
+    }
+}
+
+#if defined(GL_VERSION_4_1)
+static const char __nanogui_program_cache_magic[8] = { 'N', 'G', 'P', 'R', 'O', 'G', '0', '1' };
+
+static bool programCacheSupported_helper() {
+    return context_feature_helper("GL_ARB_get_program_binary", [] {
+        GLint formats = 0;
+        if (has_feature_helper(4, 1, "GL_ARB_get_program_binary"))
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    });
+}
+
+/* Create a program from a cached binary, or return 0 if there is none or the driver rejects it */
+static GLuint loadProgramBinary_helper(const std::string &name, const std::string &path,
+                                       const std::string &key) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    char magic[sizeof(__nanogui_program_cache_magic)];
+    uint32_t format = 0;
+    uint64_t keyLength = 0, binaryLength = 0;
+    file.read(magic, sizeof(magic));
+    file.read((char *) &format, sizeof(format));
+    file.read((char *) &keyLength, sizeof(keyLength));
+
+    /* The full key guards against collisions of the file name hash */
+    bool valid = file && memcmp(magic, __nanogui_program_cache_magic, sizeof(magic)) == 0 &&
+                 keyLength == key.length();
+    std::string storedKey(valid ? keyLength : 0, '\0');
+    std::vector<char> binary;
+    if (valid) {
+        file.read(&storedKey[0], (std::streamsize) keyLength);
+        file.read((char *) &binaryLength, sizeof(binaryLength));
+        valid = file && storedKey == key && binaryLength > 0 && binaryLength < (1ull << 31);
+    }
+    if (valid) {
+        binary.resize((size_t) binaryLength);
+        file.read(binary.data(), (std::streamsize) binaryLength);
+        valid = (bool) file;
+    }
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, (GLenum) format, binary.data(), (GLsizei) binaryLength);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        if (status != GL_TRUE) {
+            /* Pull and ignore the error raised for a binary in a format that
+               the driver no longer supports (GL_INVALID_ENUM), which would
+               otherwise be reported by the caller's next glGetError() */
+            while (glGetError() != GL_NO_ERROR)
+                ;
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (!program) {
+        std::cerr << name << ": warning: discarding program binary \"" << path
+                  << "\" rejected by the driver" << std::endl;
+        __nanogui_program_cache_statistics.rejected++;
+        file.close();
+        std::remove(path.c_str());
+    }
+    return program;
+}
+
+/* Write the binary of a linked program to the cache */
+static void storeProgramBinary_helper(const std::string &path, const std::string &key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary((size_t) length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0)
+        return;
+
+    /* Write to a temporary file first, so that other processes never read a partial binary */
+    createDirectory_helper(__nanogui_program_cache_directory);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        uint32_t format32 = (uint32_t) format;
+        uint64_t keyLength = key.length(), binaryLength = (uint64_t) length;
+        file.write(__nanogui_program_cache_magic, sizeof(__nanogui_program_cache_magic));
+        file.write((const char *) &format32, sizeof(format32));
+        file.write((const char *) &keyLength, sizeof(keyLength));
+        file.write(key.data(), (std::streamsize) key.length());
+        file.write((const char *) &binaryLength, sizeof(binaryLength));
+        file.write(binary.data(), (std::streamsize) length);
+        if (!file) {
+            file.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return;
+    }
+    __nanogui_program_cache_statistics.stored++;
+}
+#endif
+
+/* Compile and link a program from source, or load it from the program binary cache. On
+   success, the compiled shaders are returned (or 0 if the program came from the cache). */
+static GLuint buildProgram_helper(const std::string &name, const std::string &defines,
+                                  const std::string &vertex_str,
+                                  const std::string &fragment_str,
+                                  const std::string &geometry_str,
+                                  GLuint &vertexShader, GLuint &fragmentShader,
+                                  GLuint &geometryShader) {
+    vertexShader = fragmentShader = geometryShader = 0;
+
+#if defined(GL_VERSION_4_1)
+    bool cached = !__nanogui_program_cache_directory.empty() && programCacheSupported_helper();
+    std::string key, path;
+    if (cached) {
+        std::ostringstream oss;
+        oss << glGetString(GL_VENDOR) << '\n' << glGetString(GL_RENDERER) << '\n'
+            << glGetString(GL_VERSION) << '\n' << defines << '\0' << vertex_str << '\0'
+            << fragment_str << '\0' << geometry_str;
+        key = oss.str();
+        std::ostringstream filename;
+        filename << __nanogui_program_cache_directory << "/" << std::hex
+                 << hash_helper(key) << ".bin";
+        path = filename.str();
+
+        GLuint program = loadProgramBinary_helper(name, path, key);
+        if (program) {
+            __nanogui_program_cache_statistics.hits++;
+            if (__nanogui_program_cache_verbose)
+                std::cerr << name << ": loaded program binary \"" << path << "\"" << std::endl;
+            return program;
+        }
+        __nanogui_program_cache_statistics.misses++;
+        if (__nanogui_program_cache_verbose)
+            std::cerr << name << ": no program binary \"" << path << "\", compiling" << std::endl;
+    }
+#else
+    bool cached = false;
+#endif
+
+    vertexShader =
+        createShader_helper(GL_VERTEX_SHADER, name, defines, vertex_str);
+    geometryShader =
+        createShader_helper(GL_GEOMETRY_SHADER, name, defines, geometry_str);
+    fragmentShader =
+        createShader_helper(GL_FRAGMENT_SHADER, name, defines, fragment_str);
+
+    if (!vertexShader || !fragmentShader)
+        return 0;
+    if (!geometry_str.empty() && !geometryShader)
+        return 0;
+
+    GLuint program = createProgram_helper(name, vertexShader, fragmentShader,
+                                          geometryShader, cached);
+#if defined(GL_VERSION_4_1)
+    if (cached)
+        storeProgramBinary_helper(path, key, program);
+#endif
+    return program;
+}
+
+void GLShader::setProgramCacheDirectory(const std::string &directory) {
+    __nanogui_program_cache_directory = directory;
+    while (__nanogui_program_cache_directory.length() > 1 &&
+           (__nanogui_program_cache_directory.back() == '/' ||
+            __nanogui_program_cache_directory.back() == '\\'))
+        __nanogui_program_cache_directory.pop_back();
+}
+
+const std::string &GLShader::programCacheDirectory() {
+    return __nanogui_program_cache_directory;
+}
+
+void GLShader::setProgramCacheVerbose(bool verbose) {
+    __nanogui_program_cache_verbose = verbose;
+}
+
+bool GLShader::programCacheVerbose() {
+    return __nanogui_program_cache_verbose;
+}
+
+std::string GLShader::defaultProgramCacheDirectory() {
+#if defined(_WIN32)
+    const char *base = getenv("LOCALAPPDATA");
+    return base ? std::string(base) + "\\nanogui\\programs" : std::string();
+#elif defined(__APPLE__)
+    const char *home = getenv("HOME");
+    return home ? std::string(home) + "/Library/Caches/nanogui/programs" : std::string();
+#else
+    const char *base = getenv("XDG_CACHE_HOME");
+    if (base && base[0] == '/')
+        return std::string(base) + "/nanogui/programs";
+    const char *home = getenv("HOME");
+    return home ? std::string(home) + "/.cache/nanogui/programs" : std::string();
+#endif
+}
+
+const GLShader::ProgramCacheStatistics &GLShader::programCacheStatistics() {
+    return __nanogui_program_cache_statistics;
+}
+
 bool GLShader::init(const std::string &name,
                     const std::string &vertex_str,
                     const std::string &fragment_str,
@@ -98,66 +441,147 @@ bool GLShader::init(const std::string &name,
 
     glGenVertexArrays(1, &mVertexArrayObject);
     mName = name;
-    mVertexShader =
-        createShader_helper(GL_VERTEX_SHADER, name, defines, vertex_str);
-    mGeometryShader =
-        createShader_helper(GL_GEOMETRY_SHADER, name, defines, geometry_str);
-    mFragmentShader =
-        createShader_helper(GL_FRAGMENT_SHADER, name, defines, fragment_str);
-
-    if (!mVertexShader || !mFragmentShader)
-        return false;
-    if (!geometry_str.empty() && !mGeometryShader)
+    mProgramShader = buildProgram_helper(name, defines, vertex_str, fragment_str,
+                                         geometry_str, mVertexShader,
+                                         mFragmentShader, mGeometryShader);
+    if (!mProgramShader)
         return false;
 
-    mProgramShader = glCreateProgram();
+    mLocations = introspect(mProgramShader);
 
-    glAttachShader(mProgramShader, mVertexShader);
-    glAttachShader(mProgramShader, mFragmentShader);
+    return true;
+}
 
-    if (mGeometryShader)
-        glAttachShader(mProgramShader, mGeometryShader);
+bool GLShader::initShared(const std::string &name,
+                          const std::string &vertex_str,
+                          const std::string &fragment_str,
+                          const std::string &geometry_str) {
+    std::string defines;
+    for (auto def : mDefinitions)
+        defines += std::string("#define ") + def.first + std::string(" ") + def.second + "\n";
 
-    glLinkProgram(mProgramShader);
+    /* Programs are keyed by their complete sources (rather than a hash of
+       them), so that different programs can never be mistaken for another */
+    std::ostringstream key;
+    key << current_context_helper() << "|" << name << "|" << defines << '\0'
+        << vertex_str << '\0' << fragment_str << '\0' << geometry_str;
 
-    GLint status;
-    glGetProgramiv(mProgramShader, GL_LINK_STATUS, &status);
+    glGenVertexArrays(1, &mVertexArrayObject);
+    mName = name;
 
-    if (status != GL_TRUE) {
-        char buffer[512];
-        glGetProgramInfoLog(mProgramShader, 512, nullptr, buffer);
-        std::cerr << "Linker error (" << mName << "): " << std::endl << buffer << std::endl;
-        mProgramShader = 0;
-        throw std::runtime_error("Shader linking failed!");
+    auto it = __nanogui_shared_programs.find(key.str());
+    if (it == __nanogui_shared_programs.end()) {
+        GLuint vertexShader, fragmentShader, geometryShader;
+        GLuint program = buildProgram_helper(name, defines, vertex_str, fragment_str,
+                                             geometry_str, vertexShader,
+                                             fragmentShader, geometryShader);
+
+        /* The program keeps the compiled code; the shader objects are no longer needed */
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        glDeleteShader(geometryShader);
+        if (!program)
+            return false;
+
+        it = __nanogui_shared_programs.insert(
+            std::make_pair(key.str(), SharedProgram { program, 0, { }, introspect(program) })).first;
     }
 
+    it->second.refCount++;
+    mProgramShader = it->second.program;
+    mLocations = std::static_pointer_cast<Locations>(it->second.locations);
+    mSharedKey = key.str();
     return true;
 }
 
+size_t GLShader::sharedProgramCount() {
+    return __nanogui_shared_programs.size();
+}
+
 void GLShader::bind() {
     glUseProgram(mProgramShader);
     glBindVertexArray(mVertexArrayObject);
 }
 
+std::shared_ptr<GLShader::Locations> GLShader::introspect(GLuint program) {
+    auto locations = std::make_shared<Locations>();
+    GLint count = 0, maxLength = 0;
+    GLint size;
+    GLenum type;
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> buffer(std::max(maxLength, 1));
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        glGetActiveUniform(program, (GLuint) i, (GLsizei) buffer.size(), nullptr, &size, &type, buffer.data());
+        std::string name(buffer.data());
+        GLint location = glGetUniformLocation(program, name.c_str());
+        if (location < 0)
+            continue; /* Member of a uniform block */
+        locations->uniforms.emplace_back(name, location);
+        /* Arrays are reported as "name[0]", but may also be accessed as "name" */
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            locations->uniforms.emplace_back(name.substr(0, name.size() - 3), location);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        GLint length = 0;
+        glGetActiveUniformBlockiv(program, (GLuint) i, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+        std::vector<char> name(std::max(length, 1));
+        glGetActiveUniformBlockName(program, (GLuint) i, (GLsizei) name.size(), nullptr, name.data());
+        locations->uniformBlocks.emplace_back(std::string(name.data()), i);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    buffer.resize(std::max(maxLength, 1));
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    for (GLint i = 0; i < count; ++i) {
+        glGetActiveAttrib(program, (GLuint) i, (GLsizei) buffer.size(), nullptr, &size, &type, buffer.data());
+        std::string name(buffer.data());
+        GLint location = glGetAttribLocation(program, name.c_str());
+        if (location >= 0)
+            locations->attribs.emplace_back(name, location);
+    }
+
+    std::sort(locations->uniforms.begin(), locations->uniforms.end());
+    std::sort(locations->uniformBlocks.begin(), locations->uniformBlocks.end());
+    std::sort(locations->attribs.begin(), locations->attribs.end());
+    return locations;
+}
+
+/* Binary search in a table of locations sorted by name (-1 if not found) */
+static GLint find_location_helper(const std::vector<std::pair<std::string, GLint>> &table,
+                                  const std::string &name) {
+    auto it = std::lower_bound(table.begin(), table.end(), name,
+        [](const std::pair<std::string, GLint> &entry, const std::string &key) {
+            return entry.first < key;
+        });
+    return (it != table.end() && it->first == name) ? it->second : -1;
+}
+
 GLint GLShader::attrib(const std::string &name, bool warn) const {
-    GLint id = glGetAttribLocation(mProgramShader, name.c_str());
+    GLint id = mLocations ? find_location_helper(mLocations->attribs, name) : -1;
     if (id == -1 && warn)
         std::cerr << mName << ": warning: did not find attrib " << name << std::endl;
     return id;
 }
 
 void GLShader::setUniform(const std::string &name, const GLUniformBuffer &buf, bool warn) {
-    GLuint blockIndex = glGetUniformBlockIndex(mProgramShader, name.c_str());
-    if (blockIndex == GL_INVALID_INDEX) {
+    GLint blockIndex = mLocations ? find_location_helper(mLocations->uniformBlocks, name) : -1;
+    if (blockIndex == -1) {
         if (warn)
             std::cerr << mName << ": warning: did not find uniform buffer " << name << std::endl;
         return;
     }
-    glUniformBlockBinding(mProgramShader, blockIndex, buf.getBindingPoint());
+    glUniformBlockBinding(mProgramShader, (GLuint) blockIndex, buf.getBindingPoint());
 }
 
 GLint GLShader::uniform(const std::string &name, bool warn) const {
-    GLint id = glGetUniformLocation(mProgramShader, name.c_str());
+    GLint id = mLocations ? find_location_helper(mLocations->uniforms, name) : -1;
+    /* Array elements other than the first one are not part of the table */
+    if (id == -1 && mProgramShader && name.find('[') != std::string::npos)
+        id = glGetUniformLocation(mProgramShader, name.c_str());
     if (id == -1 && warn)
         std::cerr << mName << ": warning: did not find uniform " << name << std::endl;
     return id;
@@ -173,42 +597,128 @@ void GLShader::uploadAttrib(const std::string &name, size_t size, int dim,
             return;
     }
 
-    GLuint bufferID;
+    Buffer &buffer = uploadBuffer(name, size, dim, compSize, glType, data, version);
+
+    /* A buffer that held interleaved vertices before now only holds this
+       attribute, so detach the others from it */
+    if (buffer.layout) {
+        for (const VertexAttribute &attribute : *buffer.layout) {
+            int otherID = attrib(attribute.name, false);
+            if (otherID >= 0 && attribute.name != name)
+                glDisableVertexAttribArray(otherID);
+        }
+        buffer.layout.reset();
+    }
+
+    if (name != "indices") {
+        if (size == 0) {
+            glDisableVertexAttribArray(attribID);
+        } else {
+            glEnableVertexAttribArray(attribID);
+            glVertexAttribPointer(attribID, dim, glType, integral, 0, 0);
+        }
+    }
+}
+
+void GLShader::uploadVertices(const std::string &name,
+                              const std::vector<VertexAttribute> &attributes,
+                              size_t stride, size_t count, const void *data,
+                              int version) {
+    if (name == "indices")
+        throw std::runtime_error("uploadVertices(" + mName + "): invalid buffer name!");
+
+    Buffer &buffer = uploadBuffer(name, count, 1, (uint32_t) stride,
+                                  GL_UNSIGNED_BYTE, data, version);
+    if (!buffer.layout || *buffer.layout != attributes)
+        buffer.layout = std::make_shared<const std::vector<VertexAttribute>>(attributes);
+    bindVertexLayout(buffer);
+}
+
+GLShader::Buffer &GLShader::uploadBuffer(const std::string &name, size_t size, int dim,
+                                         uint32_t compSize, GLuint glType,
+                                         const void *data, int version) {
+    auto streaming = mStreamingBuffers.find(name);
+    if (streaming != mStreamingBuffers.end()) {
+        freeStreamingBuffer(streaming->second);
+        mStreamingBuffers.erase(streaming);
+    }
+
+    bool orphan = false;
     auto it = mBufferObjects.find(name);
     if (it != mBufferObjects.end()) {
         Buffer &buffer = it->second;
-        bufferID = it->second.id;
+        orphan = (size_t) buffer.size * buffer.compSize == size * (size_t) compSize;
+        buffer.glType = glType;
+        buffer.dim = dim;
         buffer.version = version;
         buffer.size = size;
         buffer.compSize = compSize;
     } else {
-        glGenBuffers(1, &bufferID);
         Buffer buffer;
-        buffer.id = bufferID;
+        glGenBuffers(1, &buffer.id);
         buffer.glType = glType;
         buffer.dim = dim;
         buffer.compSize = compSize;
         buffer.size = size;
         buffer.version = version;
-        mBufferObjects[name] = buffer;
+        it = mBufferObjects.insert(std::make_pair(name, buffer)).first;
     }
     size_t totalSize = size * (size_t) compSize;
-
-    if (name == "indices") {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferID);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, totalSize, data, GL_DYNAMIC_DRAW);
+    __nanogui_uploaded_bytes += totalSize;
+
+    GLenum target = name == "indices" ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+    glBindBuffer(target, it->second.id);
+
+    /* When rewriting a buffer of the same size, invalidate its contents so
+       that the driver can orphan the storage still read by pending draw
+       calls instead of reallocating or waiting for them */
+    void *target_data = orphan && totalSize > 0
+        ? glMapBufferRange(target, 0, totalSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT)
+        : nullptr;
+    if (target_data) {
+        memcpy(target_data, data, totalSize);
+        glUnmapBuffer(target);
     } else {
-        glBindBuffer(GL_ARRAY_BUFFER, bufferID);
-        glBufferData(GL_ARRAY_BUFFER, totalSize, data, GL_DYNAMIC_DRAW);
-        if (size == 0) {
+        glBufferData(target, totalSize, data, GL_DYNAMIC_DRAW);
+    }
+    return it->second;
+}
+
+void GLShader::bindVertexLayout(const Buffer &buffer) {
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+    for (const VertexAttribute &attribute : *buffer.layout) {
+        int attribID = attrib(attribute.name, false);
+        if (attribID < 0)
+            continue;
+        if (buffer.size == 0) {
             glDisableVertexAttribArray(attribID);
         } else {
             glEnableVertexAttribArray(attribID);
-            glVertexAttribPointer(attribID, dim, glType, integral, 0, 0);
+            glVertexAttribPointer(attribID, attribute.dim, attribute.glType,
+                                  attribute.integral, (GLsizei) buffer.compSize,
+                                  (const void *) attribute.offset);
         }
     }
 }
 
+void GLShader::updateAttrib(const std::string &name, size_t offset, size_t size,
+                            uint32_t compSize, const void *data) {
+    auto it = mBufferObjects.find(name);
+    if (it == mBufferObjects.end())
+        throw std::runtime_error("updateAttrib(" + mName + ", " + name + ") : buffer not found!");
+
+    const Buffer &buf = it->second;
+    if (buf.compSize != compSize || offset + size > buf.size)
+        throw std::runtime_error(mName + ": updateAttrib: size mismatch!");
+    if (size == 0)
+        return;
+
+    GLenum target = name == "indices" ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+    glBindBuffer(target, buf.id);
+    glBufferSubData(target, offset * (size_t) compSize, size * (size_t) compSize, data);
+    __nanogui_uploaded_bytes += size * (size_t) compSize;
+}
+
 void GLShader::downloadAttrib(const std::string &name, size_t size, int /* dim */,
                              uint32_t compSize, GLuint /* glType */, void *data) {
     auto it = mBufferObjects.find(name);
@@ -230,6 +740,157 @@ void GLShader::downloadAttrib(const std::string &name, size_t size, int /* dim *
     }
 }
 
+void GLShader::uploadSharedAttrib(const std::string &name, size_t size, int dim,
+                                  uint32_t compSize, GLuint glType, bool integral,
+                                  const void *data) {
+    auto it = __nanogui_shared_programs.find(mSharedKey);
+    if (it == __nanogui_shared_programs.end())
+        throw std::runtime_error("uploadSharedAttrib(" + mName + ", " + name + "): the program is not shared!");
+
+    int attribID = 0;
+    if (name != "indices") {
+        attribID = attrib(name);
+        if (attribID < 0)
+            return;
+    }
+
+    GLenum target = name == "indices" ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+    auto buf = it->second.buffers.find(name);
+    if (buf == it->second.buffers.end()) {
+        SharedBuffer buffer { 0, glType, dim, integral };
+        glGenBuffers(1, &buffer.id);
+        glBindBuffer(target, buffer.id);
+        glBufferData(target, size * (size_t) compSize, data, GL_STATIC_DRAW);
+        __nanogui_uploaded_bytes += size * (size_t) compSize;
+        buf = it->second.buffers.insert(std::make_pair(name, buffer)).first;
+    }
+
+    const SharedBuffer &buffer = buf->second;
+    glBindBuffer(target, buffer.id);
+    if (name != "indices") {
+        glEnableVertexAttribArray(attribID);
+        glVertexAttribPointer(attribID, buffer.dim, buffer.glType, buffer.integral, 0, 0);
+    }
+}
+
+bool GLShader::persistentMappingSupported() {
+#if defined(GL_MAP_PERSISTENT_BIT)
+    return context_feature_helper("GL_ARB_buffer_storage", [] {
+        return has_feature_helper(4, 4, "GL_ARB_buffer_storage");
+    });
+#else
+    return false;
+#endif
+}
+
+bool GLShader::multiDrawIndirectSupported() {
+#if defined(GL_VERSION_4_3)
+    return context_feature_helper("GL_ARB_multi_draw_indirect", [] {
+        return has_feature_helper(4, 3, "GL_ARB_multi_draw_indirect");
+    });
+#else
+    return false;
+#endif
+}
+
+void GLShader::streamAttrib(const std::string &name, size_t size, int dim,
+                            uint32_t compSize, GLuint glType, bool integral,
+                            const void *data, int segments) {
+    if (name == "indices")
+        throw std::runtime_error("streamAttrib(" + mName + "): index buffers cannot be streamed!");
+    int attribID = attrib(name);
+    if (attribID < 0)
+        return;
+
+    auto regular = mBufferObjects.find(name);
+    if (regular != mBufferObjects.end()) {
+        glDeleteBuffers(1, &regular->second.id);
+        mBufferObjects.erase(regular);
+    }
+
+    size_t totalSize = size * (size_t) compSize;
+    segments = std::max(segments, 2);
+
+    auto it = mStreamingBuffers.find(name);
+    if (it != mStreamingBuffers.end() &&
+        (it->second.segmentSize < totalSize || (int) it->second.fences.size() != segments)) {
+        freeStreamingBuffer(it->second);
+        mStreamingBuffers.erase(it);
+        it = mStreamingBuffers.end();
+    }
+
+    if (it == mStreamingBuffers.end()) {
+        /* Keep the regions aligned, with some headroom for growing data */
+        size_t segmentSize = std::max(((totalSize + totalSize / 4) + 255) & ~(size_t) 255, (size_t) 256);
+        StreamingBuffer buffer { 0, segmentSize, -1, nullptr, std::vector<GLsync>(segments, nullptr) };
+        glGenBuffers(1, &buffer.id);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.id);
+#if defined(GL_MAP_PERSISTENT_BIT)
+        if (persistentMappingSupported()) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, segmentSize * segments, nullptr, flags);
+            buffer.mapped = (uint8_t *) glMapBufferRange(GL_ARRAY_BUFFER, 0, segmentSize * segments, flags);
+        }
+#endif
+        if (!buffer.mapped)
+            glBufferData(GL_ARRAY_BUFFER, segmentSize * segments, nullptr, GL_STREAM_DRAW);
+        it = mStreamingBuffers.insert(std::make_pair(name, buffer)).first;
+    } else {
+        glBindBuffer(GL_ARRAY_BUFFER, it->second.id);
+    }
+
+    /* Retire the region written by the previous call, and wait until the
+       draw calls of the region to be written next have completed */
+    StreamingBuffer &buffer = it->second;
+    if (buffer.segment >= 0)
+        buffer.fences[buffer.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer.segment = (buffer.segment + 1) % segments;
+    GLsync &fence = buffer.fences[buffer.segment];
+    if (fence) {
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+            ;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    size_t offset = (size_t) buffer.segment * buffer.segmentSize;
+    if (totalSize > 0) {
+        if (buffer.mapped) {
+            memcpy(buffer.mapped + offset, data, totalSize);
+        } else {
+            void *target = glMapBufferRange(GL_ARRAY_BUFFER, offset, totalSize,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            if (!target)
+                throw std::runtime_error("streamAttrib(" + mName + ", " + name + "): could not map buffer!");
+            memcpy(target, data, totalSize);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        __nanogui_uploaded_bytes += totalSize;
+    }
+
+    if (size == 0) {
+        glDisableVertexAttribArray(attribID);
+    } else {
+        glEnableVertexAttribArray(attribID);
+        glVertexAttribPointer(attribID, dim, glType, integral, 0, (const void *) offset);
+    }
+}
+
+void GLShader::freeStreamingBuffer(StreamingBuffer &buffer) {
+    for (GLsync fence : buffer.fences)
+        if (fence)
+            glDeleteSync(fence);
+    glDeleteBuffers(1, &buffer.id);
+}
+
+size_t GLShader::uploadedBytes() {
+    return __nanogui_uploaded_bytes;
+}
+
+void GLShader::resetUploadedBytes() {
+    __nanogui_uploaded_bytes = 0;
+}
+
 void GLShader::shareAttrib(const GLShader &otherShader, const std::string &name, const std::string &_as) {
     std::string as = _as.length() == 0 ? name : _as;
     auto it = otherShader.mBufferObjects.find(name);
@@ -237,7 +898,9 @@ void GLShader::shareAttrib(const GLShader &otherShader, const std::string &name,
         throw std::runtime_error("shareAttribute(" + otherShader.mName + ", " + name + "): attribute not found!");
     const Buffer &buffer = it->second;
 
-    if (name != "indices") {
+    if (buffer.layout) {
+        bindVertexLayout(buffer);
+    } else if (name != "indices") {
         int attribID = attrib(as);
         if (attribID < 0)
             return;
@@ -260,6 +923,11 @@ void GLShader::freeAttrib(const std::string &name) {
         glDeleteBuffers(1, &it->second.id);
         mBufferObjects.erase(it);
     }
+    auto it2 = mStreamingBuffers.find(name);
+    if (it2 != mStreamingBuffers.end()) {
+        freeStreamingBuffer(it2->second);
+        mStreamingBuffers.erase(it2);
+    }
 }
 
 void GLShader::drawIndexed(int type, uint32_t offset_, uint32_t count_) {
@@ -284,17 +952,158 @@ void GLShader::drawArray(int type, uint32_t offset, uint32_t count) {
     glDrawArrays(type, offset, count);
 }
 
+void GLShader::setAttribDivisor(const std::string &name, uint32_t divisor) {
+    auto it = mBufferObjects.find(name);
+    if (it != mBufferObjects.end() && it->second.layout) {
+        for (const VertexAttribute &attribute : *it->second.layout) {
+            int attribID = attrib(attribute.name, false);
+            if (attribID >= 0)
+                glVertexAttribDivisor(attribID, divisor);
+        }
+    } else {
+        int attribID = attrib(name);
+        if (attribID >= 0)
+            glVertexAttribDivisor(attribID, divisor);
+    }
+}
+
+void GLShader::drawArrayInstanced(int type, uint32_t offset, uint32_t count, uint32_t instances) {
+    if (count == 0 || instances == 0)
+        return;
+
+    glDrawArraysInstanced(type, offset, count, instances);
+}
+
+void GLShader::drawIndexedInstanced(int type, uint32_t offset_, uint32_t count_, uint32_t instances) {
+    if (count_ == 0 || instances == 0)
+        return;
+    size_t offset = offset_;
+    size_t count = count_;
+
+    switch (type) {
+        case GL_TRIANGLES: offset *= 3; count *= 3; break;
+        case GL_LINES: offset *= 2; count *= 2; break;
+    }
+
+    glDrawElementsInstanced(type, (GLsizei) count, GL_UNSIGNED_INT,
+                            (const void *)(offset * sizeof(uint32_t)), instances);
+}
+
+void GLShader::multiDrawArray(int type, const DrawArrayCommand *commands, size_t count) {
+    if (count == 0)
+        return;
+
+#if defined(GL_VERSION_4_3)
+    if (multiDrawIndirectSupported()) {
+        if (!mIndirectBuffer)
+            glGenBuffers(1, &mIndirectBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawArrayCommand), commands, GL_STREAM_DRAW);
+        glMultiDrawArraysIndirect(type, nullptr, (GLsizei) count, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        return;
+    }
+#endif
+
+    bool single = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (commands[i].baseInstance != 0)
+            throw std::runtime_error("multiDrawArray(" + mName + "): base instances are not supported!");
+        single &= commands[i].instanceCount == 1;
+    }
+
+    if (single) {
+        std::vector<GLint> first(count);
+        std::vector<GLsizei> counts(count);
+        for (size_t i = 0; i < count; ++i) {
+            first[i] = (GLint) commands[i].first;
+            counts[i] = (GLsizei) commands[i].count;
+        }
+        glMultiDrawArrays(type, first.data(), counts.data(), (GLsizei) count);
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            if (commands[i].count > 0 && commands[i].instanceCount > 0)
+                glDrawArraysInstanced(type, commands[i].first, commands[i].count,
+                                      commands[i].instanceCount);
+    }
+}
+
+void GLShader::multiDrawIndexed(int type, const DrawIndexedCommand *commands, size_t count) {
+    if (count == 0)
+        return;
+
+#if defined(GL_VERSION_4_3)
+    if (multiDrawIndirectSupported()) {
+        if (!mIndirectBuffer)
+            glGenBuffers(1, &mIndirectBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, count * sizeof(DrawIndexedCommand), commands, GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(type, GL_UNSIGNED_INT, nullptr, (GLsizei) count, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        return;
+    }
+#endif
+
+    bool single = true;
+    for (size_t i = 0; i < count; ++i) {
+        if (commands[i].baseInstance != 0)
+            throw std::runtime_error("multiDrawIndexed(" + mName + "): base instances are not supported!");
+        single &= commands[i].instanceCount == 1;
+    }
+
+    if (single) {
+        std::vector<GLsizei> counts(count);
+        std::vector<const void *> offsets(count);
+        std::vector<GLint> baseVertex(count);
+        for (size_t i = 0; i < count; ++i) {
+            counts[i] = (GLsizei) commands[i].count;
+            offsets[i] = (const void *) (commands[i].firstIndex * sizeof(uint32_t));
+            baseVertex[i] = commands[i].baseVertex;
+        }
+        glMultiDrawElementsBaseVertex(type, counts.data(), GL_UNSIGNED_INT, offsets.data(),
+                                      (GLsizei) count, baseVertex.data());
+    } else {
+        for (size_t i = 0; i < count; ++i)
+            if (commands[i].count > 0 && commands[i].instanceCount > 0)
+                glDrawElementsInstancedBaseVertex(
+                    type, commands[i].count, GL_UNSIGNED_INT,
+                    (const void *) (commands[i].firstIndex * sizeof(uint32_t)),
+                    commands[i].instanceCount, commands[i].baseVertex);
+    }
+}
+
 void GLShader::free() {
     for (auto &buf: mBufferObjects)
         glDeleteBuffers(1, &buf.second.id);
     mBufferObjects.clear();
+    for (auto &buf: mStreamingBuffers)
+        freeStreamingBuffer(buf.second);
+    mStreamingBuffers.clear();
 
     if (mVertexArrayObject) {
         glDeleteVertexArrays(1, &mVertexArrayObject);
         mVertexArrayObject = 0;
     }
 
-    glDeleteProgram(mProgramShader); mProgramShader = 0;
+    if (mIndirectBuffer) {
+        glDeleteBuffers(1, &mIndirectBuffer);
+        mIndirectBuffer = 0;
+    }
+
+    if (!mSharedKey.empty()) {
+        auto it = __nanogui_shared_programs.find(mSharedKey);
+        if (it != __nanogui_shared_programs.end() && --it->second.refCount == 0) {
+            for (auto &buf : it->second.buffers)
+                glDeleteBuffers(1, &buf.second.id);
+            glDeleteProgram(it->second.program);
+            __nanogui_shared_programs.erase(it);
+        }
+        mSharedKey.clear();
+    } else {
+        glDeleteProgram(mProgramShader);
+    }
+    mProgramShader = 0;
+    mLocations.reset();
     glDeleteShader(mVertexShader);   mVertexShader = 0;
     glDeleteShader(mFragmentShader); mFragmentShader = 0;
     glDeleteShader(mGeometryShader); mGeometryShader = 0;
@@ -366,9 +1175,10 @@ void GLFramebuffer::init(const Vector2i &size, int nSamples) {
 }
 
 void GLFramebuffer::free() {
+    glDeleteFramebuffers(1, &mFramebuffer);
     glDeleteRenderbuffers(1, &mColor);
     glDeleteRenderbuffers(1, &mDepth);
-    mColor = mDepth = 0;
+    mFramebuffer = mColor = mDepth = 0;
 }
 
 void GLFramebuffer::bind() {
@@ -394,6 +1204,23 @@ void GLFramebuffer::blit() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void GLFramebuffer::downloadPixels(uint8_t *rgba) {
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, mFramebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glReadPixels(0, 0, mSize.x(), mSize.y(), GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    /* OpenGL stores the bottom row first */
+    uint32_t rowSize = mSize.x() * 4;
+    std::vector<uint8_t> line(rowSize);
+    for (int i = 0, j = mSize.y() - 1; i < j; ++i, --j) {
+        memcpy(line.data(), rgba + i * rowSize, rowSize);
+        memcpy(rgba + i * rowSize, rgba + j * rowSize, rowSize);
+        memcpy(rgba + j * rowSize, line.data(), rowSize);
+    }
+}
+
 void GLFramebuffer::downloadTGA(const std::string &filename) {
     uint8_t *temp = new uint8_t[mSize.prod() * 4];
 
@@ -10,19 +10,142 @@
 */
 
 #include <nanogui/graph.h>
+#include <nanogui/screen.h>
 #include <nanogui/theme.h>
 #include <nanogui/opengl.h>
 #include <nanogui/serializer/core.h>
+#include <limits>
 
 NAMESPACE_BEGIN(nanogui)
 
 Graph::Graph(Widget *parent, const std::string &caption)
-    : Widget(parent), mCaption(caption) {
+    : Widget(parent), mCaption(caption), mStreamCapacity(0), mStreamMask(0),
+      mStreamHead(0), mStreamReserved(0), mStreamScreen(nullptr), mPyramidEnabled(false),
+      mRangeBegin(0), mRangeEnd(0) {
     mBackgroundColor = Color(20, 128);
     mForegroundColor = Color(255, 192, 0, 128);
     mTextColor = Color(240, 192);
 }
 
+void Graph::setStreamCapacity(size_t capacity) {
+    mStreamCapacity = capacity;
+    mStreamHead.store(0, std::memory_order_relaxed);
+    mStreamReserved.store(0, std::memory_order_relaxed);
+    if (capacity == 0) {
+        mStream.reset();
+        mStreamMask = 0;
+    } else {
+        /* Reserve at least the capacity again as slack for the producer */
+        size_t size = 1;
+        while (size < 2 * capacity)
+            size *= 2;
+        mStream.reset(new float[size]);
+        mStreamMask = size - 1;
+    }
+    setPyramidEnabled(mPyramidEnabled);
+    markDirty();
+}
+
+void Graph::setValues(const VectorXf &values) {
+    mValues = values;
+    setPyramidEnabled(mPyramidEnabled);
+    markDirty();
+}
+
+Graph::~Graph() {
+    if (mDataSource)
+        mDataSource->setScreen(nullptr);
+}
+
+void Graph::setDataSource(GraphDataSource *source) {
+    if (mDataSource && mDataSource.get() != source)
+        mDataSource->setScreen(nullptr);
+    mDataSource = source;
+    setPyramidEnabled(mPyramidEnabled);
+    markDirty();
+}
+
+void Graph::setPyramidEnabled(bool enabled) {
+    mPyramidEnabled = enabled;
+    mPyramidMin.clear();
+    mPyramidMax.clear();
+    bool stream = mStreamCapacity > 0;
+    if (!enabled || (mDataSource && !stream))
+        return;
+
+    /* Allocate the levels down to two entries (of the ring buffer or of the
+       complete blocks of values()) and fill them from the current samples */
+    size_t size = stream ? mStreamMask + 1 : (size_t) mValues.size();
+    for (size_t entries = size / 2; entries >= 2; entries /= 2) {
+        mPyramidMin.push_back(std::vector<float>(entries));
+        mPyramidMax.push_back(std::vector<float>(entries));
+    }
+    size_t head = stream ? mStreamHead.load(std::memory_order_acquire) : size;
+    updatePyramid(head - std::min(head, size), head);
+    markDirty();
+}
+
+void Graph::updatePyramid(size_t begin, size_t end) {
+    bool stream = mStreamCapacity > 0;
+    for (size_t k = 1; k <= mPyramidMin.size(); ++k) {
+        std::vector<float> &min = mPyramidMin[k - 1], &max = mPyramidMax[k - 1];
+        size_t mask = stream ? min.size() - 1 : (size_t) -1;
+        /* Entries whose block of samples was completed by this update */
+        for (size_t j = begin >> k; j < end >> k; ++j) {
+            float min0, max0, min1, max1;
+            if (k == 1) {
+                min0 = max0 = sample(2 * j);
+                min1 = max1 = sample(2 * j + 1);
+            } else {
+                const std::vector<float> &cmin = mPyramidMin[k - 2], &cmax = mPyramidMax[k - 2];
+                size_t cmask = stream ? cmin.size() - 1 : (size_t) -1;
+                min0 = cmin[(2 * j) & cmask]; max0 = cmax[(2 * j) & cmask];
+                min1 = cmin[(2 * j + 1) & cmask]; max1 = cmax[(2 * j + 1) & cmask];
+            }
+            min[j & mask] = std::min(min0, min1);
+            max[j & mask] = std::max(max0, max1);
+        }
+    }
+}
+
+void Graph::push(float value) {
+    size_t head = mStreamHead.load(std::memory_order_relaxed);
+    /* Announce the overwritten slot before writing it (see Graph::draw()) */
+    mStreamReserved.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mStream[head & mStreamMask] = value;
+    if (mPyramidEnabled)
+        updatePyramid(head, head + 1);
+    mStreamHead.store(head + 1, std::memory_order_release);
+    notifyStream();
+}
+
+void Graph::pushBatch(const float *values, size_t count) {
+    size_t head = mStreamHead.load(std::memory_order_relaxed);
+    size_t size = mStreamMask + 1;
+    /* Only the last ring buffer's worth of samples can be retained */
+    if (count > size) {
+        head += count - size;
+        values += count - size;
+        count = size;
+    }
+    mStreamReserved.store(head + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    size_t offset = head & mStreamMask, tail = std::min(count, size - offset);
+    std::copy(values, values + tail, mStream.get() + offset);
+    std::copy(values + tail, values + count, mStream.get());
+    if (mPyramidEnabled)
+        updatePyramid(head, head + count);
+    mStreamHead.store(head + count, std::memory_order_release);
+    notifyStream();
+}
+
+void Graph::notifyStream() {
+    Screen *screen = mStreamScreen.load(std::memory_order_acquire);
+    if (screen)
+        screen->redraw();
+}
+
 Vector2i Graph::preferredSize(NVGcontext *) const {
     return Vector2i(180, 45);
 }
@@ -35,24 +158,50 @@ void Graph::draw(NVGcontext *ctx) {
     nvgFillColor(ctx, mBackgroundColor);
     nvgFill(ctx);
 
-    if (mValues.size() < 2)
-        return;
+    /* The samples [origin, origin + slots) span the width of the graph */
+    bool ranged = mRangeEnd > mRangeBegin;
+    if (mStreamCapacity > 0) {
+        /* Producers request redraws of the screen that shows the graph */
+        Screen *screen = dynamic_cast<Screen *>(this->screen());
+        mStreamScreen.store(screen, std::memory_order_release);
 
-    nvgBeginPath(ctx);
-    nvgMoveTo(ctx, mPos.x(), mPos.y()+mSize.y());
-    for (size_t i = 0; i < (size_t) mValues.size(); i++) {
-        float value = mValues[i];
-        float vx = mPos.x() + i * mSize.x() / (float) (mValues.size() - 1);
-        float vy = mPos.y() + (1-value) * mSize.y();
-        nvgLineTo(ctx, vx, vy);
+        /* Trace the newest samples in place from the ring buffer. The
+           producer announces the samples it is about to overwrite before
+           writing them, so having read only samples past that many slots
+           behind means that none of them (nor the pyramid entries covering
+           them) changed while tracing. Otherwise, trace the now newest ones */
+        bool valid = false;
+        for (int attempt = 0; attempt < 4 && !valid; ++attempt) {
+            size_t head = mStreamHead.load(std::memory_order_acquire);
+            size_t oldest = head - std::min(head, mStreamCapacity), begin, end;
+            if (ranged) {
+                begin = std::min(std::max(mRangeBegin, oldest), head);
+                end = std::min(std::max(mRangeEnd, begin), head);
+            } else {
+                begin = oldest;
+                end = head;
+            }
+            traceVertices(begin, end,
+                          ranged ? (double) mRangeBegin : (double) head - (double) mStreamCapacity,
+                          ranged ? mRangeEnd - mRangeBegin : mStreamCapacity);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            valid = begin + mStreamMask + 1 >= mStreamReserved.load(std::memory_order_relaxed);
+        }
+        if (valid)
+            drawVertices(ctx);
+        else if (screen)
+            screen->redraw();
+    } else {
+        if (mDataSource)
+            mDataSource->setScreen(dynamic_cast<Screen *>(screen()));
+        size_t count = mDataSource ? mDataSource->size() : (size_t) mValues.size();
+        traceVertices(ranged ? std::min(mRangeBegin, count) : 0,
+                      ranged ? std::min(mRangeEnd, count) : count,
+                      ranged ? (double) mRangeBegin : 0.0,
+                      ranged ? mRangeEnd - mRangeBegin : count);
+        drawVertices(ctx);
     }
 
-    nvgLineTo(ctx, mPos.x() + mSize.x(), mPos.y() + mSize.y());
-    nvgStrokeColor(ctx, Color(100, 255));
-    nvgStroke(ctx);
-    nvgFillColor(ctx, mForegroundColor);
-    nvgFill(ctx);
-
     nvgFontFace(ctx, "sans");
 
     if (!mCaption.empty()) {
@@ -82,6 +231,105 @@ void Graph::draw(NVGcontext *ctx) {
     nvgStroke(ctx);
 }
 
+void Graph::sampleRange(size_t begin, size_t end, float &min, float &max) const {
+    min = std::numeric_limits<float>::infinity();
+    max = -std::numeric_limits<float>::infinity();
+    auto merge = [&](float entryMin, float entryMax) {
+        min = std::min(min, entryMin);
+        max = std::max(max, entryMax);
+    };
+    bool stream = mStreamCapacity > 0;
+    if (mDataSource && !stream) {
+        mDataSource->range(begin, end, min, max);
+        return;
+    }
+
+    /* Cover the range with the largest aligned pyramid blocks, taking at
+       most two entries per level */
+    size_t k = 0;
+    while (begin < end) {
+        if (k == 0 && (end - begin <= 64 || mPyramidMin.empty())) {
+            /* Raw samples (in up to two contiguous pieces of the ring
+               buffer). Eigen vectorizes these reductions (SSE/AVX/NEON,
+               depending on the target) */
+            if (!stream) {
+                auto piece = mValues.segment((Eigen::DenseIndex) begin, (Eigen::DenseIndex) (end - begin));
+                merge(piece.minCoeff(), piece.maxCoeff());
+            } else {
+                size_t offset = begin & mStreamMask;
+                size_t count = std::min(end - begin, mStreamMask + 1 - offset);
+                Eigen::Map<const VectorXf> first(mStream.get() + offset, (Eigen::DenseIndex) count);
+                merge(first.minCoeff(), first.maxCoeff());
+                if (count < end - begin) {
+                    Eigen::Map<const VectorXf> second(mStream.get(), (Eigen::DenseIndex) (end - begin - count));
+                    merge(second.minCoeff(), second.maxCoeff());
+                }
+            }
+            break;
+        }
+        if (k > 0) {
+            const std::vector<float> &lmin = mPyramidMin[k - 1], &lmax = mPyramidMax[k - 1];
+            size_t mask = stream ? lmin.size() - 1 : (size_t) -1;
+            if (k == mPyramidMin.size() || end - begin <= 2) {
+                for (size_t j = begin; j < end; ++j)
+                    merge(lmin[j & mask], lmax[j & mask]);
+                break;
+            }
+            if (begin & 1) {
+                merge(lmin[begin & mask], lmax[begin & mask]);
+                begin++;
+            }
+            if (end & 1) {
+                end--;
+                merge(lmin[end & mask], lmax[end & mask]);
+            }
+        } else {
+            if (begin & 1) {
+                merge(sample(begin), sample(begin));
+                begin++;
+            }
+            if (end & 1) {
+                end--;
+                merge(sample(end), sample(end));
+            }
+        }
+        begin >>= 1;
+        end >>= 1;
+        k++;
+    }
+}
+
+void Graph::traceVertices(size_t begin, size_t end, double origin, size_t slots) {
+    mVertices.clear();
+    if (end < begin + 2 || slots < 2)
+        return;
+
+    double dx = mSize.x() / (double) (slots - 1);
+    auto vx = [&](size_t i) { return (float) (mPos.x() + (i - origin) * dx); };
+    auto vy = [&](float value) { return mPos.y() + (1-value) * mSize.y(); };
+
+    mVertices.push_back(Vector2f(vx(begin), mPos.y() + mSize.y()));
+    traceSeries(begin, end, origin, dx,
+        [&](size_t i) { return sample(i); },
+        [&](size_t i0, size_t i1, float &min, float &max) { sampleRange(i0, i1, min, max); },
+        [&](float x, float value) { mVertices.push_back(Vector2f(mPos.x() + x, vy(value))); });
+    mVertices.push_back(Vector2f(vx(end - 1), mPos.y() + mSize.y()));
+}
+
+void Graph::drawVertices(NVGcontext *ctx) {
+    if (mVertices.empty())
+        return;
+
+    nvgBeginPath(ctx);
+    nvgMoveTo(ctx, mVertices[0].x(), mVertices[0].y());
+    for (size_t i = 1; i < mVertices.size(); ++i)
+        nvgLineTo(ctx, mVertices[i].x(), mVertices[i].y());
+    nvgStrokeColor(ctx, Color(100, 255));
+    nvgStroke(ctx);
+    nvgFillColor(ctx, mForegroundColor);
+    nvgFill(ctx);
+}
+
 void Graph::save(Serializer &s) const {
     Widget::save(s);
     s.set("caption", mCaption);
@@ -102,6 +350,7 @@ bool Graph::load(Serializer &s) {
     if (!s.get("foregroundColor", mForegroundColor)) return false;
     if (!s.get("textColor", mTextColor)) return false;
     if (!s.get("values", mValues)) return false;
+    setPyramidEnabled(mPyramidEnabled);
     return true;
 }
 
@@ -0,0 +1,257 @@
+/*
+    src/graphdata.cpp -- Data sources supplying the samples plotted
+    by a Graph, including memory-mapped sample files
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/graphdata.h>
+#include <nanogui/screen.h>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_WIN32)
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+NAMESPACE_BEGIN(nanogui)
+
+/* Range of a contiguous run of samples; Eigen vectorizes these reductions */
+static void merge_range(const float *data, size_t count, float &min, float &max) {
+    if (count == 0)
+        return;
+    Eigen::Map<const VectorXf> values(data, (Eigen::DenseIndex) count);
+    min = std::min(min, values.minCoeff());
+    max = std::max(max, values.maxCoeff());
+}
+
+void GraphDataSource::range(size_t begin, size_t end, float &min, float &max) const {
+    min = std::numeric_limits<float>::infinity();
+    max = -std::numeric_limits<float>::infinity();
+    for (size_t i = begin; i < end; ++i) {
+        float v = value(i);
+        min = std::min(min, v);
+        max = std::max(max, v);
+    }
+}
+
+MappedGraphDataSource::MappedGraphDataSource(const std::string &filename, size_t offset)
+    : mData(nullptr), mSize(0), mMapping(nullptr), mMappingSize(0),
+      mSummarizedCount(0), mRequested((size_t) -1), mStop(false), mScreen(nullptr) {
+#if defined(_WIN32)
+    mFile = mMappingHandle = nullptr;
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Could not open \"" + filename + "\"!");
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    mFile = file;
+    mMappingSize = (size_t) fileSize.QuadPart;
+    if (mMappingSize > offset) {
+        mMappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mMappingHandle)
+            mMapping = MapViewOfFile((HANDLE) mMappingHandle, FILE_MAP_READ, 0, 0, 0);
+        if (!mMapping) {
+            if (mMappingHandle)
+                CloseHandle((HANDLE) mMappingHandle);
+            CloseHandle(file);
+            throw std::runtime_error("Could not map \"" + filename + "\"!");
+        }
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Could not open \"" + filename + "\"!");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not determine the size of \"" + filename + "\"!");
+    }
+    mMappingSize = (size_t) st.st_size;
+    if (mMappingSize > offset) {
+        mMapping = mmap(nullptr, mMappingSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mMapping == MAP_FAILED) {
+            mMapping = nullptr;
+            close(fd);
+            throw std::runtime_error("Could not map \"" + filename + "\"!");
+        }
+    }
+    /* The mapping stays valid after closing the file */
+    close(fd);
+#endif
+
+    if (mMapping) {
+        mData = (const float *) ((const uint8_t *) mMapping + offset);
+        mSize = (mMappingSize - offset) / sizeof(float);
+    }
+    mBlockCount = (mSize + BlockSize - 1) / BlockSize;
+    mBlockMin.resize(mBlockCount);
+    mBlockMax.resize(mBlockCount);
+    mBlockValid.reset(new std::atomic<bool>[mBlockCount]);
+    for (size_t i = 0; i < mBlockCount; ++i)
+        mBlockValid[i] = false;
+    if (mBlockCount > 0)
+        mThread = std::thread([this] { run(); });
+}
+
+MappedGraphDataSource::~MappedGraphDataSource() {
+    mStop = true;
+    if (mThread.joinable())
+        mThread.join();
+#if defined(_WIN32)
+    if (mMapping)
+        UnmapViewOfFile(mMapping);
+    if (mMappingHandle)
+        CloseHandle((HANDLE) mMappingHandle);
+    if (mFile)
+        CloseHandle((HANDLE) mFile);
+#else
+    if (mMapping)
+        munmap(mMapping, mMappingSize);
+#endif
+}
+
+void MappedGraphDataSource::range(size_t begin, size_t end, float &min, float &max) const {
+    min = std::numeric_limits<float>::infinity();
+    max = -std::numeric_limits<float>::infinity();
+    end = std::min(end, mSize);
+    if (begin >= end)
+        return;
+
+    /* Only the blocks lying completely inside the range use cached summaries */
+    size_t firstBlock = (begin + BlockSize - 1) / BlockSize, lastBlock = end / BlockSize;
+    if (firstBlock >= lastBlock) {
+        merge_range(mData + begin, end - begin, min, max);
+        return;
+    }
+    merge_range(mData + begin, firstBlock * BlockSize - begin, min, max);
+    size_t pending = 0, firstPending = 0;
+    for (size_t block = firstBlock; block < lastBlock; ++block) {
+        if (!mBlockValid[block].load(std::memory_order_acquire)) {
+            if (pending++ == 0)
+                firstPending = block;
+            continue;
+        }
+        min = std::min(min, mBlockMin[block]);
+        max = std::max(max, mBlockMax[block]);
+    }
+    merge_range(mData + lastBlock * BlockSize, end - lastBlock * BlockSize, min, max);
+
+    if (pending > 0) {
+        /* Estimate the blocks that are not summarized yet from a bounded
+           number of samples, and let the background thread continue there */
+        const size_t samples = 32;
+        size_t step = std::max((lastBlock - firstPending) / samples, (size_t) 1);
+        for (size_t block = firstPending; block < lastBlock; block += step) {
+            size_t index = block * BlockSize + (block * 2654435761u) % BlockSize;
+            float value = mData[std::min(index, mSize - 1)];
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+        mRequested.store(firstPending, std::memory_order_relaxed);
+    }
+}
+
+void MappedGraphDataSource::run() {
+    using clock = std::chrono::steady_clock;
+    const size_t batch = 64;
+    size_t cursor = 0;
+    auto lastRedraw = clock::now();
+    bool changed = false;
+
+    while (!mStop && mSummarizedCount.load(std::memory_order_relaxed) < mBlockCount) {
+        /* Prefer the blocks that were drawn most recently */
+        size_t requested = mRequested.exchange((size_t) -1, std::memory_order_relaxed);
+        size_t begin = requested != (size_t) -1 ? requested : cursor;
+        while (begin < mBlockCount && mBlockValid[begin].load(std::memory_order_relaxed))
+            begin++;
+        if (begin >= mBlockCount) {
+            cursor = 0;
+            continue;
+        }
+        size_t end = std::min(begin + batch, mBlockCount);
+        summarize(begin, end);
+        if (requested == (size_t) -1)
+            cursor = end;
+        changed = true;
+
+        /* Redraw periodically while summaries arrive, and once at the end */
+        bool done = mSummarizedCount.load(std::memory_order_relaxed) == mBlockCount;
+        if (done || clock::now() - lastRedraw > std::chrono::milliseconds(100)) {
+            if (changed) {
+                std::lock_guard<std::mutex> guard(mScreenMutex);
+                if (mScreen)
+                    mScreen->redraw();
+            }
+            lastRedraw = clock::now();
+            changed = false;
+        }
+    }
+}
+
+void MappedGraphDataSource::setScreen(Screen *screen) {
+    /* Wait for a redraw in progress, so that the previous screen may be
+       destroyed as soon as this returns */
+    std::lock_guard<std::mutex> guard(mScreenMutex);
+    mScreen = screen;
+}
+
+void MappedGraphDataSource::summarize(size_t begin, size_t end) {
+    size_t block = begin;
+    while (block < end) {
+        if (mBlockValid[block].load(std::memory_order_relaxed)) {
+            block++;
+            continue;
+        }
+
+        /* Summarize a run of unknown blocks */
+        size_t runBegin = block;
+        for (; block < end && !mBlockValid[block].load(std::memory_order_relaxed); ++block) {
+            size_t first = block * BlockSize, count = std::min(BlockSize, mSize - first);
+            float min = std::numeric_limits<float>::infinity();
+            float max = -std::numeric_limits<float>::infinity();
+            merge_range(mData + first, count, min, max);
+            mBlockMin[block] = min;
+            mBlockMax[block] = max;
+            mBlockValid[block].store(true, std::memory_order_release);
+            mSummarizedCount.fetch_add(1, std::memory_order_release);
+        }
+
+        /* Release the pages of the run, which are not needed anymore */
+#if defined(_WIN32)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        size_t pageSize = (size_t) info.dwPageSize;
+#else
+        size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+#endif
+        uintptr_t runStart = (uintptr_t) (mData + runBegin * BlockSize);
+        uintptr_t runEnd = (uintptr_t) (mData + std::min(block * BlockSize, mSize));
+        runStart = (runStart + pageSize - 1) / pageSize * pageSize;
+        runEnd = runEnd / pageSize * pageSize;
+        if (runEnd > runStart) {
+#if defined(_WIN32)
+            /* Unlocking pages that are not locked removes them from the working set */
+            VirtualUnlock((void *) runStart, runEnd - runStart);
+#else
+            madvise((void *) runStart, runEnd - runStart, MADV_DONTNEED);
+#endif
+        }
+    }
+}
+
+NAMESPACE_END(nanogui)
@@ -15,6 +15,8 @@
 #include <nanogui/window.h>
 #include <nanogui/screen.h>
 #include <nanogui/theme.h>
+#include <nanogui/tiledimage.h>
+#include <algorithm>
 #include <cmath>
 
 NAMESPACE_BEGIN(nanogui)
@@ -44,10 +46,14 @@ namespace {
         R"(#version 330
         uniform vec2 scaleFactor;
         uniform vec2 position;
+        uniform vec2 pixelOffset;
+        uniform vec2 pixelScale;
         in vec2 vertex;
         out vec2 uv;
+        out vec2 pixel;
         void main() {
             uv = vertex;
+            pixel = pixelOffset + vertex * pixelScale;
             vec2 scaledVertex = (vertex * scaleFactor) + position;
             gl_Position  = vec4(2.0*scaledVertex.x - 1.0,
                                 1.0 - 2.0*scaledVertex.y,
@@ -58,10 +64,50 @@ namespace {
     constexpr char const *const defaultImageViewFragmentShader =
         R"(#version 330
         uniform sampler2D image;
+        uniform float gridOpacity;
         out vec4 color;
         in vec2 uv;
+        in vec2 pixel;
         void main() {
             color = texture(image, uv);
+            // Pixel grid: one screen pixel wide lines along the top/left edge of each image pixel
+            if (any(lessThan(fract(pixel), fwidth(pixel))))
+                color = mix(color, vec4(1.0), gridOpacity);
+        })";
+
+    constexpr char const *const tiledImageViewVertexShader =
+        R"(#version 330
+        uniform vec2 scaleFactor;
+        uniform vec2 position;
+        uniform vec2 uvOffset;
+        uniform vec2 uvScale;
+        uniform vec2 pixelOffset;
+        uniform vec2 pixelScale;
+        in vec2 vertex;
+        out vec2 uv;
+        out vec2 pixel;
+        void main() {
+            uv = uvOffset + vertex * uvScale;
+            pixel = pixelOffset + vertex * pixelScale;
+            vec2 scaledVertex = (vertex * scaleFactor) + position;
+            gl_Position  = vec4(2.0*scaledVertex.x - 1.0,
+                                1.0 - 2.0*scaledVertex.y,
+                                0.0, 1.0);
+
+        })";
+
+    constexpr char const *const tiledImageViewFragmentShader =
+        R"(#version 330
+        uniform sampler2DArray tiles;
+        uniform float layer;
+        uniform float gridOpacity;
+        out vec4 color;
+        in vec2 uv;
+        in vec2 pixel;
+        void main() {
+            color = texture(tiles, vec3(uv, layer));
+            if (any(lessThan(fract(pixel), fwidth(pixel))))
+                color = mix(color, vec4(1.0), gridOpacity);
         })";
 
 }
@@ -70,8 +116,24 @@ ImageView::ImageView(Widget* parent, GLuint imageID)
     : Widget(parent), mImageID(imageID), mScale(1.0f), mOffset(Vector2f::Zero()),
     mFixedScale(false), mFixedOffset(false), mPixelInfoCallback(nullptr) {
     updateImageParameters();
-    mShader.init("ImageViewShader", defaultImageViewVertexShader,
-                 defaultImageViewFragmentShader);
+    initShader(false);
+}
+
+ImageView::~ImageView() {
+    if (mStreamingTexture)
+        mStreamingTexture->setScreen(nullptr);
+    mShader.free();
+}
+
+void ImageView::initShader(bool tiled) {
+    // All image views share the linked programs and the quad buffers.
+    mShader.free();
+    if (tiled)
+        mShader.initShared("ImageViewTiledShader", tiledImageViewVertexShader,
+                           tiledImageViewFragmentShader);
+    else
+        mShader.initShared("ImageViewShader", defaultImageViewVertexShader,
+                           defaultImageViewFragmentShader);
 
     MatrixXu indices(3, 2);
     indices.col(0) << 0, 1, 2;
@@ -84,18 +146,51 @@ ImageView::ImageView(Widget* parent, GLuint imageID)
     vertices.col(3) << 1, 1;
 
     mShader.bind();
-    mShader.uploadIndices(indices);
-    mShader.uploadAttrib("vertex", vertices);
+    mShader.uploadSharedAttrib("indices", indices);
+    mShader.uploadSharedAttrib("vertex", vertices);
 }
 
-ImageView::~ImageView() {
-    mShader.free();
+void ImageView::bindTiledImage(TiledImageSource *source, int cacheCapacity) {
+    mImageID = 0;
+    if (mStreamingTexture)
+        mStreamingTexture->setScreen(nullptr);
+    mStreamingTexture = nullptr;
+    mTileCache.reset(new TileCache(source, cacheCapacity));
+    initShader(true);
+    mImageSize = source->size();
+    fit();
+    invalidatePreferredSize();
+    invalidatePixelInfo();
+}
+
+void ImageView::bindStreamingTexture(StreamingTexture *texture) {
+    if (mTileCache) {
+        mTileCache.reset();
+        initShader(false);
+    }
+    mImageID = 0;
+    if (mStreamingTexture && mStreamingTexture.get() != texture)
+        mStreamingTexture->setScreen(nullptr);
+    mStreamingTexture = texture;
+    mImageSize = texture->size();
+    fit();
+    invalidatePreferredSize();
+    invalidatePixelInfo();
 }
 
 void ImageView::bindImage(GLuint imageId) {
+    if (mTileCache) {
+        mTileCache.reset();
+        initShader(false);
+    }
+    if (mStreamingTexture)
+        mStreamingTexture->setScreen(nullptr);
+    mStreamingTexture = nullptr;
     mImageID = imageId;
     updateImageParameters();
     fit();
+    invalidatePreferredSize();
+    invalidatePixelInfo();
 }
 
 Vector2f ImageView::imageCoordinateAt(const Vector2f& position) const {
@@ -291,7 +386,7 @@ void ImageView::draw(NVGcontext* ctx) {
 
     // Calculate several variables that need to be send to OpenGL in order for the image to be
     // properly displayed inside the widget.
-    const Screen* screen = dynamic_cast<const Screen*>(this->window()->parent());
+    Screen* screen = dynamic_cast<Screen*>(this->window()->parent());
     assert(screen);
     Vector2f screenSize = screen->size().cast<float>();
     Vector2f scaleFactor = mScale * imageSizeF().cwiseQuotient(screenSize);
@@ -303,13 +398,32 @@ void ImageView::draw(NVGcontext* ctx) {
     glScissor(positionInScreen.x() * r,
               (screenSize.y() - positionInScreen.y() - size().y()) * r,
               size().x() * r, size().y() * r);
-    mShader.bind();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, mImageID);
-    mShader.setUniform("image", 0);
-    mShader.setUniform("scaleFactor", scaleFactor);
-    mShader.setUniform("position", imagePosition);
-    mShader.drawIndexed(GL_TRIANGLES, 0, 2);
+    if (mTileCache) {
+        mTileCache->setScreen(screen);
+        drawTiles(screenSize, positionAfterOffset, r);
+    } else {
+        if (mStreamingTexture) {
+            // Never waits for the producer or the transfers; keep drawing while frames are in flight.
+            mStreamingTexture->setScreen(screen);
+            mImageID = mStreamingTexture->update();
+            if (mStreamingTexture->framePending())
+                screen->redraw();
+            if (mStreamingTexture->shownCount() != mPixelInfoFrame) {
+                mPixelInfoFrame = mStreamingTexture->shownCount();
+                invalidatePixelInfo();
+            }
+        }
+        mShader.bind();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, mImageID);
+        mShader.setUniform("image", 0);
+        mShader.setUniform("scaleFactor", scaleFactor);
+        mShader.setUniform("position", imagePosition);
+        mShader.setUniform("pixelOffset", Vector2f(Vector2f::Zero()));
+        mShader.setUniform("pixelScale", imageSizeF());
+        mShader.setUniform("gridOpacity", gridVisible() ? 0.2f : 0.0f);
+        mShader.drawIndexed(GL_TRIANGLES, 0, 2);
+    }
     glDisable(GL_SCISSOR_TEST);
 
     if (helpersVisible())
@@ -318,6 +432,79 @@ void ImageView::draw(NVGcontext* ctx) {
     drawWidgetBorder(ctx);
 }
 
+void ImageView::drawTiles(const Vector2f& screenSize, const Vector2f& imagePosition, float pixelRatio) {
+    TiledImageSource *source = mTileCache->source();
+    int levels = source->levelCount(), tileSize = source->tileSize();
+
+    // Use the coarsest mipmap level that still provides a texel per physical pixel.
+    float texelsPerPixel = 1.0f / (mScale * pixelRatio);
+    int level = std::max(0, std::min(levels - 1, (int) std::floor(std::log2(texelsPerPixel))));
+
+    // Determine the range of tiles of a level that intersect the widget.
+    Vector2f visibleMin = clampedImageCoordinateAt(Vector2f::Zero());
+    Vector2f visibleMax = clampedImageCoordinateAt(sizeF());
+    auto visibleTiles = [&](int l, Vector2i& first, Vector2i& last) {
+        float extent = (float) (tileSize << l);
+        first = (visibleMin / extent).unaryExpr([](float x) { return std::floor(x); }).cast<int>();
+        last = (visibleMax / extent).unaryExpr([](float x) { return std::ceil(x); }).cast<int>()
+                   .cwiseMin(source->tileCount(l)).cwiseMax(first);
+    };
+
+    // Request the coarsest level first, so that every tile soon has a fallback, and then the
+    // tiles of the current level starting from the center of the widget.
+    std::vector<std::pair<int, Vector2i>> tiles, requests;
+    Vector2i first, last;
+    visibleTiles(levels - 1, first, last);
+    for (int y = first.y(); y < last.y(); ++y)
+        for (int x = first.x(); x < last.x(); ++x)
+            requests.emplace_back(levels - 1, Vector2i(x, y));
+    visibleTiles(level, first, last);
+    for (int y = first.y(); y < last.y(); ++y)
+        for (int x = first.x(); x < last.x(); ++x)
+            tiles.emplace_back(level, Vector2i(x, y));
+    Vector2f center = (first + last).cast<float>() / 2;
+    std::sort(tiles.begin(), tiles.end(), [&](const std::pair<int, Vector2i>& a, const std::pair<int, Vector2i>& b) {
+        return (a.second.cast<float>() - center).squaredNorm() < (b.second.cast<float>() - center).squaredNorm();
+    });
+    if (level != levels - 1)
+        requests.insert(requests.end(), tiles.begin(), tiles.end());
+
+    mTileCache->update();
+    mTileCache->request(requests);
+
+    mShader.bind();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mTileCache->texture());
+    mShader.setUniform("tiles", 0);
+    mShader.setUniform("gridOpacity", gridVisible() ? 0.2f : 0.0f);
+
+    // Draw each tile using the finest resident level covering it.
+    float extent = (float) (tileSize << level);
+    for (const auto& tile : tiles) {
+        Vector2f tileMin = tile.second.cast<float>() * extent;
+        Vector2f tileMax = (tileMin + Vector2f::Constant(extent)).cwiseMin(imageSizeF());
+        for (int l = level; l < levels; ++l) {
+            Vector2i parent(tile.second.x() >> (l - level), tile.second.y() >> (l - level));
+            int layer = mTileCache->lookup(l, parent);
+            if (layer < 0)
+                continue;
+            float parentExtent = (float) (tileSize << l);
+            Vector2f uvOffset = (tileMin - parent.cast<float>() * parentExtent) / parentExtent;
+            Vector2f uvScale = (tileMax - tileMin) / parentExtent;
+            mShader.setUniform("scaleFactor", Vector2f(mScale * (tileMax - tileMin).cwiseQuotient(screenSize)));
+            mShader.setUniform("position", Vector2f((imagePosition + mScale * tileMin).cwiseQuotient(screenSize)));
+            mShader.setUniform("uvOffset", uvOffset);
+            mShader.setUniform("uvScale", uvScale);
+            mShader.setUniform("layer", (float) layer);
+            mShader.setUniform("pixelOffset", tileMin);
+            mShader.setUniform("pixelScale", Vector2f(tileMax - tileMin));
+            mShader.drawIndexed(GL_TRIANGLES, 0, 2);
+            break;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
 void ImageView::updateImageParameters() {
     // Query the width of the OpenGL texture.
     glBindTexture(GL_TEXTURE_2D, mImageID);
@@ -357,43 +544,13 @@ void ImageView::drawImageBorder(NVGcontext* ctx) const {
     nvgRestore(ctx);
 }
 
-void ImageView::drawHelpers(NVGcontext* ctx) const {
-    // We need to apply mPos after the transformation to account for the position of the widget
-    // relative to the parent.
-    Vector2f upperLeftCorner = positionForCoordinate(Vector2f::Zero()) + positionF();
-    Vector2f lowerRightCorner = positionForCoordinate(imageSizeF()) + positionF();
-    if (gridVisible())
-        drawPixelGrid(ctx, upperLeftCorner, lowerRightCorner, mScale);
+void ImageView::drawHelpers(NVGcontext* ctx) {
+    // The pixel grid is drawn by the image shader.
     if (pixelInfoVisible())
         drawPixelInfo(ctx, mScale);
 }
 
-void ImageView::drawPixelGrid(NVGcontext* ctx, const Vector2f& upperLeftCorner,
-                              const Vector2f& lowerRightCorner, float stride) {
-    nvgBeginPath(ctx);
-
-    // Draw the vertical grid lines
-    float currentX = upperLeftCorner.x();
-    while (currentX <= lowerRightCorner.x()) {
-        nvgMoveTo(ctx, std::round(currentX), std::round(upperLeftCorner.y()));
-        nvgLineTo(ctx, std::round(currentX), std::round(lowerRightCorner.y()));
-        currentX += stride;
-    }
-
-    // Draw the horizontal grid lines
-    float currentY = upperLeftCorner.y();
-    while (currentY <= lowerRightCorner.y()) {
-        nvgMoveTo(ctx, std::round(upperLeftCorner.x()), std::round(currentY));
-        nvgLineTo(ctx, std::round(lowerRightCorner.x()), std::round(currentY));
-        currentY += stride;
-    }
-
-    nvgStrokeWidth(ctx, 1.0f);
-    nvgStrokeColor(ctx, Color(1.0f, 1.0f, 1.0f, 0.2f));
-    nvgStroke(ctx);
-}
-
-void ImageView::drawPixelInfo(NVGcontext* ctx, float stride) const {
+void ImageView::drawPixelInfo(NVGcontext* ctx, float stride) {
     // Extract the image coordinates at the two corners of the widget.
     Vector2i topLeft = clampedImageCoordinateAt(Vector2f::Zero())
                            .unaryExpr([](float x) { return std::floor(x); })
@@ -403,12 +560,9 @@ void ImageView::drawPixelInfo(NVGcontext* ctx, float stride) const {
                                .unaryExpr([](float x) { return std::ceil(x); })
                                .cast<int>();
 
-    // Extract the positions for where to draw the text.
-    Vector2f currentCellPosition =
-        (positionF() + positionForCoordinate(topLeft.cast<float>()));
-
-    float xInitialPosition = currentCellPosition.x();
-    int xInitialIndex = topLeft.x();
+    // Only query the pixel information callback when the visible pixels change.
+    if (!mPixelInfoValid || topLeft != mPixelInfoTopLeft || bottomRight != mPixelInfoBottomRight)
+        updatePixelInfo(topLeft, bottomRight);
 
     // Properly scale the pixel information for the given stride.
     auto fontSize = stride * mFontScaleFactor;
@@ -416,37 +570,55 @@ void ImageView::drawPixelInfo(NVGcontext* ctx, float stride) const {
     fontSize = fontSize > maxFontSize ? maxFontSize : fontSize;
     nvgBeginPath(ctx);
     nvgFontSize(ctx, fontSize);
-    nvgTextAlign(ctx, NVG_ALIGN_CENTER | NVG_ALIGN_TOP);
+    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
     nvgFontFace(ctx, "sans");
-    while (topLeft.y() != bottomRight.y()) {
-        while (topLeft.x() != bottomRight.x()) {
-            writePixelInfo(ctx, currentCellPosition, topLeft, stride, fontSize);
-            currentCellPosition.x() += stride;
-            ++topLeft.x();
+
+    // Centered text is measured by NanoVG on every call, so measure the texts
+    // once per font size instead and draw them left-aligned.
+    if (fontSize != mPixelInfoFontSize) {
+        for (auto& group : mPixelInfoLayout)
+            for (auto& text : group.second)
+                text.width = nvgTextBounds(ctx, 0, 0, text.text.c_str(), nullptr, nullptr);
+        mPixelInfoFontSize = fontSize;
+    }
+
+    for (const auto& group : mPixelInfoLayout) {
+        nvgFillColor(ctx, group.first);
+        for (const auto& text : group.second) {
+            Vector2f cellPosition = positionF() + positionForCoordinate(text.pixel.cast<float>());
+            float yOffset = (stride - fontSize * text.rows) / 2 + fontSize * text.row;
+            nvgText(ctx, cellPosition.x() + (stride - text.width) / 2, cellPosition.y() + yOffset,
+                    text.text.c_str(), nullptr);
         }
-        currentCellPosition.x() = xInitialPosition;
-        currentCellPosition.y() += stride;
-        ++topLeft.y();
-        topLeft.x() = xInitialIndex;
     }
 }
 
-void ImageView::writePixelInfo(NVGcontext* ctx, const Vector2f& cellPosition,
-                               const Vector2i& pixel, float stride, float fontSize) const {
-    auto pixelData = mPixelInfoCallback(pixel);
-    auto pixelDataRows = tokenize(pixelData.first);
-
-    // If no data is provided for this pixel then simply return.
-    if (pixelDataRows.empty())
-        return;
-
-    nvgFillColor(ctx, pixelData.second);
-    float yOffset = (stride - fontSize * pixelDataRows.size()) / 2;
-    for (size_t i = 0; i != pixelDataRows.size(); ++i) {
-        nvgText(ctx, cellPosition.x() + stride / 2, cellPosition.y() + yOffset,
-                pixelDataRows[i].data(), nullptr);
-        yOffset += fontSize;
+void ImageView::updatePixelInfo(const Vector2i& topLeft, const Vector2i& bottomRight) {
+    mPixelInfoLayout.clear();
+    for (int y = topLeft.y(); y < bottomRight.y(); ++y) {
+        for (int x = topLeft.x(); x < bottomRight.x(); ++x) {
+            auto pixelData = mPixelInfoCallback(Vector2i(x, y));
+            auto pixelDataRows = tokenize(pixelData.first);
+
+            // If no data is provided for this pixel then simply skip it.
+            if (pixelDataRows.empty())
+                continue;
+
+            // Group the text by color to avoid redundant state changes while drawing.
+            auto group = std::find_if(mPixelInfoLayout.begin(), mPixelInfoLayout.end(),
+                [&](const std::pair<Color, std::vector<PixelText>>& g) { return g.first == pixelData.second; });
+            if (group == mPixelInfoLayout.end())
+                group = mPixelInfoLayout.insert(group, std::make_pair(pixelData.second, std::vector<PixelText>()));
+
+            for (size_t i = 0; i != pixelDataRows.size(); ++i)
+                group->second.push_back(PixelText { Vector2i(x, y), (int) i, (int) pixelDataRows.size(),
+                                                    std::move(pixelDataRows[i]), 0.f });
+        }
     }
+    mPixelInfoFontSize = -1;
+    mPixelInfoTopLeft = topLeft;
+    mPixelInfoBottomRight = bottomRight;
+    mPixelInfoValid = true;
 }
 
 NAMESPACE_END(nanogui)
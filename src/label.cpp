@@ -36,17 +36,14 @@ void Label::setTheme(Theme *theme) {
 Vector2i Label::preferredSize(NVGcontext *ctx) const {
     if (mCaption == "")
         return Vector2i::Zero();
-    nvgFontFace(ctx, mFont.c_str());
-    nvgFontSize(ctx, fontSize());
     if (mFixedSize.x() > 0) {
         float bounds[4];
-        nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
-        nvgTextBoxBounds(ctx, mPos.x(), mPos.y(), mFixedSize.x(), mCaption.c_str(), nullptr, bounds);
+        mTheme->mTextMetrics->textBoxBounds(ctx, mFont, fontSize(), mFixedSize.x(),
+                                            mCaption, bounds);
         return Vector2i(mFixedSize.x(), bounds[3] - bounds[1]);
     } else {
-        nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
         return Vector2i(
-            nvgTextBounds(ctx, 0, 0, mCaption.c_str(), nullptr, nullptr) + 2,
+            mTheme->mTextMetrics->textBounds(ctx, mFont, fontSize(), mCaption) + 2,
             fontSize()
         );
     }
@@ -48,7 +48,7 @@ Vector2i BoxLayout::preferredSize(NVGcontext *ctx, const Widget *widget) const {
         else
             size[axis1] += mSpacing;
 
-        Vector2i ps = w->preferredSize(ctx), fs = w->fixedSize();
+        Vector2i ps = w->cachedPreferredSize(ctx), fs = w->fixedSize();
         Vector2i targetSize(
             fs[0] ? fs[0] : ps[0],
             fs[1] ? fs[1] : ps[1]
@@ -91,7 +91,7 @@ void BoxLayout::performLayout(NVGcontext *ctx, Widget *widget) const {
         else
             position += mSpacing;
 
-        Vector2i ps = w->preferredSize(ctx), fs = w->fixedSize();
+        Vector2i ps = w->cachedPreferredSize(ctx), fs = w->fixedSize();
         Vector2i targetSize(
             fs[0] ? fs[0] : ps[0],
             fs[1] ? fs[1] : ps[1]
@@ -139,7 +139,7 @@ Vector2i GroupLayout::preferredSize(NVGcontext *ctx, const Widget *widget) const
             height += (label == nullptr) ? mSpacing : mGroupSpacing;
         first = false;
 
-        Vector2i ps = c->preferredSize(ctx), fs = c->fixedSize();
+        Vector2i ps = c->cachedPreferredSize(ctx), fs = c->fixedSize();
         Vector2i targetSize(
             fs[0] ? fs[0] : ps[0],
             fs[1] ? fs[1] : ps[1]
@@ -175,7 +175,7 @@ void GroupLayout::performLayout(NVGcontext *ctx, Widget *widget) const {
 
         bool indentCur = indent && label == nullptr;
         Vector2i ps = Vector2i(availableWidth - (indentCur ? mGroupIndent : 0),
-                               c->preferredSize(ctx).y());
+                               c->cachedPreferredSize(ctx).y());
         Vector2i fs = c->fixedSize();
 
         Vector2i targetSize(
@@ -237,7 +237,7 @@ void GridLayout::computeLayout(NVGcontext *ctx, const Widget *widget, std::vecto
                 w = widget->children()[child++];
             } while (!w->visible());
 
-            Vector2i ps = w->preferredSize(ctx);
+            Vector2i ps = w->cachedPreferredSize(ctx);
             Vector2i fs = w->fixedSize();
             Vector2i targetSize(
                 fs[0] ? fs[0] : ps[0],
@@ -305,7 +305,7 @@ void GridLayout::performLayout(NVGcontext *ctx, Widget *widget) const {
                 w = widget->children()[child++];
             } while (!w->visible());
 
-            Vector2i ps = w->preferredSize(ctx);
+            Vector2i ps = w->cachedPreferredSize(ctx);
             Vector2i fs = w->fixedSize();
             Vector2i targetSize(
                 fs[0] ? fs[0] : ps[0],
@@ -386,7 +386,7 @@ void AdvancedGridLayout::performLayout(NVGcontext *ctx, Widget *widget) const {
 
             int itemPos = grid[axis][anchor.pos[axis]];
             int cellSize  = grid[axis][anchor.pos[axis] + anchor.size[axis]] - itemPos;
-            int ps = w->preferredSize(ctx)[axis], fs = w->fixedSize()[axis];
+            int ps = w->cachedPreferredSize(ctx)[axis], fs = w->fixedSize()[axis];
             int targetSize = fs ? fs : ps;
 
             switch (anchor.align[axis]) {
@@ -442,7 +442,7 @@ void AdvancedGridLayout::computeLayout(NVGcontext *ctx, const Widget *widget,
                 const Anchor &anchor = pair.second;
                 if ((anchor.size[axis] == 1) != (phase == 0))
                     continue;
-                int ps = w->preferredSize(ctx)[axis], fs = w->fixedSize()[axis];
+                int ps = w->cachedPreferredSize(ctx)[axis], fs = w->fixedSize()[axis];
                 int targetSize = fs ? fs : ps;
 
                 if (anchor.pos[axis] + anchor.size[axis] > (int) grid.size())
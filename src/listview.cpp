@@ -0,0 +1,255 @@
+/*
+    src/listview.cpp -- Scrollable list that only instantiates widgets
+    for the visible rows of a (potentially huge) data source
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/listview.h>
+#include <nanogui/window.h>
+#include <nanogui/label.h>
+#include <nanogui/theme.h>
+#include <nanogui/opengl.h>
+#include <nanogui/serializer/core.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+static const int scroller_width = 12;
+static const int scroller_end_padding = 4;
+static const int knob_width = 8;
+static const int rows_per_scroll_step = 3;
+static const size_t unbound_row = (size_t) -1;
+
+ListView::ListView(Widget *parent)
+    : Widget(parent), mRowHeight(25), mOverscan(2), mScroll(0.f) {
+    mCreateRowCallback = [](Widget *parent) -> Widget * {
+        return new Label(parent, "");
+    };
+}
+
+void ListView::setRowCountCallback(const std::function<size_t()> &callback) {
+    mRowCountCallback = callback;
+    reloadData();
+}
+
+void ListView::setBindRowCallback(const std::function<void(Widget *, size_t)> &callback) {
+    mBindRowCallback = callback;
+    reloadData();
+}
+
+void ListView::setCreateRowCallback(const std::function<Widget *(Widget *)> &callback) {
+    mCreateRowCallback = callback;
+    /* Discard the existing row widgets; they are recreated by the next layout */
+    while (!mRows.empty()) {
+        removeChild(mRows.back());
+        mRows.pop_back();
+    }
+    mRowIndex.clear();
+    invalidatePreferredSize();
+}
+
+void ListView::setRowHeight(int rowHeight) {
+    mRowHeight = std::max(rowHeight, 1);
+    invalidatePreferredSize();
+}
+
+void ListView::setOverscan(int overscan) {
+    mOverscan = std::max(overscan, 0);
+    markLayoutDirty();
+}
+
+void ListView::setScroll(float scroll) {
+    float maxScroll = std::max(0.f, contentHeight() - mSize.y());
+    scroll = std::max(0.f, std::min(maxScroll, scroll));
+    if (scroll == mScroll)
+        return;
+    mScroll = scroll;
+    updateRows();
+    markDirty();
+}
+
+void ListView::scrollToRow(size_t index) {
+    float top = (float) index * mRowHeight;
+    if (top < mScroll)
+        setScroll(top);
+    else if (top + mRowHeight > mScroll + mSize.y())
+        setScroll(top + mRowHeight - mSize.y());
+}
+
+Widget *ListView::rowWidget(size_t index) {
+    if (mRows.empty())
+        return nullptr;
+    size_t slot = index % mRows.size();
+    return mRowIndex[slot] == index ? mRows[slot] : nullptr;
+}
+
+void ListView::reloadData() {
+    /* The number of rows may have changed */
+    setScroll(mScroll);
+    updatePool();
+    updateRows(true);
+    markLayoutDirty();
+    markDirty();
+}
+
+void ListView::updatePool() {
+    size_t count = rowCount();
+    size_t viewportRows = (size_t) (mSize.y() + mRowHeight - 1) / mRowHeight + 1;
+    size_t poolSize = std::min(count, viewportRows + 2 * (size_t) mOverscan);
+    if (poolSize == mRows.size() || !mCreateRowCallback)
+        return;
+
+    while (mRows.size() > poolSize) {
+        removeChild(mRows.back());
+        mRows.pop_back();
+    }
+    while (mRows.size() < poolSize) {
+        Widget *row = mCreateRowCallback(this);
+        if (row->parent() != this)
+            addChild(row);
+        mRows.push_back(row);
+    }
+
+    /* The mapping from row indices to widgets depends on the pool size */
+    mRowIndex.assign(mRows.size(), unbound_row);
+}
+
+void ListView::updateRows(bool rebind) {
+    if (mRows.empty())
+        return;
+
+    size_t count = rowCount(), poolSize = mRows.size();
+    size_t first = firstVisibleRow();
+    first = first > (size_t) mOverscan ? first - mOverscan : 0;
+    first = std::min(first, count - std::min(count, poolSize));
+    int rowWidth = mSize.x() - scroller_width;
+
+    for (size_t index = first; index < first + poolSize && index < count; ++index) {
+        size_t slot = index % poolSize;
+        Widget *row = mRows[slot];
+        row->setPosition(Vector2i(0, (int) ((double) index * mRowHeight - mScroll)));
+
+        if (mRowIndex[slot] != index || rebind) {
+            mRowIndex[slot] = index;
+            if (mBindRowCallback)
+                mBindRowCallback(row, index);
+            /* Lay out the row again before it is drawn next time */
+            row->markLayoutDirty();
+        }
+        if (row->fixedSize() != Vector2i(rowWidth, mRowHeight)) {
+            /* A fixed size makes each row the boundary of its own relayouts */
+            row->setFixedSize(Vector2i(rowWidth, mRowHeight));
+            row->setSize(row->fixedSize());
+        }
+    }
+}
+
+void ListView::performLayout(NVGcontext *ctx) {
+    /* Confine the height to the window and parent like VScrollPanel */
+    if (mFixedSize.y() == 0) {
+        if (window()) {
+            int ypos_in_window = absolutePosition().y() - window()->absolutePosition().y();
+            mSize.y() = std::min(mSize.y(), window()->height() - ypos_in_window);
+        }
+        if (parent())
+            mSize.y() = std::min(mSize.y(), parent()->height() - mPos.y());
+        invalidateParentIndex();
+    }
+
+    updatePool();
+    float maxScroll = std::max(0.f, contentHeight() - mSize.y());
+    mScroll = std::max(0.f, std::min(maxScroll, mScroll));
+    updateRows();
+
+    for (auto row : mRows)
+        row->performLayout(ctx);
+}
+
+Vector2i ListView::preferredSize(NVGcontext *ctx) const {
+    int width = mRows.empty() ? 0 : mRows[0]->cachedPreferredSize(ctx).x();
+    return Vector2i(width + scroller_width, (int) std::min(contentHeight(), 1e9f));
+}
+
+bool ListView::mouseDragEvent(const Vector2i &p, const Vector2i &rel,
+                              int button, int modifiers) {
+    float content = contentHeight();
+    if (content <= mSize.y())
+        return Widget::mouseDragEvent(p, rel, button, modifiers);
+
+    float knob_height = std::max(mSize.y() * mSize.y() / content, (float) knob_width);
+    float track = mSize.y() - 2 * scroller_end_padding - knob_height;
+    if (track > 0)
+        setScroll(mScroll + rel.y() * (content - mSize.y()) / track);
+    return true;
+}
+
+bool ListView::scrollEvent(const Vector2i &p, const Vector2f &rel) {
+    if (contentHeight() <= mSize.y())
+        return Widget::scrollEvent(p, rel);
+    setScroll(mScroll - rel.y() * rows_per_scroll_step * mRowHeight);
+    return true;
+}
+
+void ListView::draw(NVGcontext *ctx) {
+    /* Rows lying outside of the viewport are culled by Widget::draw() */
+    Widget::draw(ctx);
+
+    float content = contentHeight();
+    if (content <= mSize.y())
+        return;
+
+    float knob_height = std::max(mSize.y() * mSize.y() / content, (float) knob_width);
+    float knob_pos = (mSize.y() - 2 * scroller_end_padding - knob_height) *
+                     mScroll / (content - mSize.y());
+
+    NVGpaint paint = nvgBoxGradient(ctx,
+        mPos.x() + mSize.x() - scroller_width + 1,
+        mPos.y() + scroller_end_padding + 1,
+        knob_width,
+        mSize.y() - 2*scroller_end_padding,
+        3, 4, Color(0, 32), Color(0, 92));
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx,
+                   mPos.x() + mSize.x() - scroller_width,
+                   mPos.y() + scroller_end_padding,
+                   knob_width,
+                   mSize.y() - 2*scroller_end_padding, 3);
+    nvgFillPaint(ctx, paint);
+    nvgFill(ctx);
+
+    paint = nvgBoxGradient(ctx,
+        mPos.x() + mSize.x() - scroller_width - 1,
+        mPos.y() + scroller_end_padding + knob_pos - 1,
+        knob_width, knob_height,
+        3, 4, Color(220, 100), Color(128, 100));
+    nvgBeginPath(ctx);
+    nvgRoundedRect(ctx,
+                   mPos.x() + mSize.x() - scroller_width + 1,
+                   mPos.y() + scroller_end_padding + 1 + knob_pos,
+                   knob_width - 2,
+                   knob_height - 2, 2);
+    nvgFillPaint(ctx, paint);
+    nvgFill(ctx);
+}
+
+void ListView::save(Serializer &s) const {
+    Widget::save(s);
+    s.set("rowHeight", mRowHeight);
+    s.set("overscan", mOverscan);
+    s.set("scroll", mScroll);
+}
+
+bool ListView::load(Serializer &s) {
+    if (!Widget::load(s)) return false;
+    if (!s.get("rowHeight", mRowHeight)) return false;
+    if (!s.get("overscan", mOverscan)) return false;
+    if (!s.get("scroll", mScroll)) return false;
+    return true;
+}
+
+NAMESPACE_END(nanogui)
@@ -0,0 +1,184 @@
+/*
+    src/plotcanvas.cpp -- Canvas widget plotting line series with
+    OpenGL, for dense data where NanoVG paths become too expensive
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/plotcanvas.h>
+#include <nanogui/theme.h>
+#include <nanogui/opengl.h>
+#include <nanogui/serializer/core.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+PlotCanvas::PlotCanvas(Widget *parent)
+    : GLCanvas(parent), mBufferValid(false), mYRange(0.f, 1.f),
+      mAxesVisible(true), mTickCount(4) {
+    mBackgroundColor = Color(20, 255);
+
+    /* All plot canvases use the same program, and set every uniform before drawing */
+    mShader.initShared(
+        /* An identifying name */
+        "plot_canvas_shader",
+
+        /* Vertex shader: the horizontal position follows from the vertex
+           index, with the newest sample at the right edge */
+        "#version 330\n"
+        "uniform int first;\n"
+        "uniform float capacity;\n"
+        "uniform float shift;\n"
+        "uniform vec2 yRange;\n"
+        "in float value;\n"
+        "void main() {\n"
+        "    float x = (float(gl_VertexID - first) + shift) / max(capacity - 1.0, 1.0);\n"
+        "    float y = (value - yRange.x) / (yRange.y - yRange.x);\n"
+        "    gl_Position = vec4(2.0 * x - 1.0, 2.0 * y - 1.0, 0.0, 1.0);\n"
+        "}",
+
+        /* Fragment shader */
+        "#version 330\n"
+        "uniform vec4 color;\n"
+        "out vec4 outColor;\n"
+        "void main() {\n"
+        "    outColor = color;\n"
+        "}"
+    );
+}
+
+PlotCanvas::~PlotCanvas() {
+    mShader.free();
+}
+
+int PlotCanvas::addSeries(size_t capacity, const Color &color) {
+    Series series;
+    series.capacity = std::max(capacity, (size_t) 1);
+    series.values.resize(series.capacity);
+    series.head = series.uploaded = 0;
+    series.offset = mSeries.empty() ? 0 :
+        mSeries.back().offset + 2 * mSeries.back().capacity;
+    series.color = color;
+    mSeries.push_back(series);
+    /* The shared buffer is reallocated before the next frame */
+    mBufferValid = false;
+    markDirty();
+    return (int) mSeries.size() - 1;
+}
+
+void PlotCanvas::pushBatch(int index, const float *values, size_t count) {
+    Series &series = mSeries[index];
+    /* Only the last capacity's worth of samples is retained */
+    if (count > series.capacity) {
+        series.head += count - series.capacity;
+        values += count - series.capacity;
+        count = series.capacity;
+    }
+    for (size_t i = 0; i < count; ++i)
+        series.values[(series.head + i) % series.capacity] = values[i];
+    series.head += count;
+    markDirty();
+}
+
+void PlotCanvas::clearSeries(int index) {
+    Series &series = mSeries[index];
+    series.head = series.uploaded = 0;
+    markDirty();
+}
+
+void PlotCanvas::uploadSeries(size_t index) {
+    Series &series = mSeries[index];
+    size_t begin = std::max(series.uploaded, series.head - std::min(series.head, series.capacity));
+
+    /* Copy each run of new samples to both of its slots */
+    while (begin < series.head) {
+        size_t slot = begin % series.capacity;
+        size_t count = std::min(series.head - begin, series.capacity - slot);
+        const float *data = series.values.data() + slot;
+        mShader.updateAttrib("value", series.offset + slot, count, sizeof(float), data);
+        mShader.updateAttrib("value", series.offset + series.capacity + slot, count, sizeof(float), data);
+        begin += count;
+    }
+    series.uploaded = series.head;
+}
+
+void PlotCanvas::drawGL() {
+    if (mSeries.empty())
+        return;
+
+    mShader.bind();
+    if (!mBufferValid) {
+        const Series &last = mSeries.back();
+        mShader.uploadAttrib("value", last.offset + 2 * last.capacity, 1,
+                             sizeof(float), GL_FLOAT, false, nullptr);
+        for (auto &series : mSeries)
+            series.uploaded = 0;
+        mBufferValid = true;
+    }
+
+    mShader.setUniform("yRange", mYRange);
+    for (size_t i = 0; i < mSeries.size(); ++i) {
+        uploadSeries(i);
+
+        const Series &series = mSeries[i];
+        size_t count = std::min(series.head, series.capacity);
+        if (count < 2)
+            continue;
+        size_t first = series.offset + (series.head - count) % series.capacity;
+        mShader.setUniform("first", (int) first);
+        mShader.setUniform("capacity", (float) series.capacity);
+        mShader.setUniform("shift", (float) (series.capacity - count));
+        mShader.setUniform("color", Vector4f(series.color));
+        mShader.drawArray(GL_LINE_STRIP, (uint32_t) first, (uint32_t) count);
+    }
+}
+
+void PlotCanvas::draw(NVGcontext *ctx) {
+    GLCanvas::draw(ctx);
+
+    if (!mAxesVisible)
+        return;
+
+    /* Horizontal grid lines with labels at the ticks of the vertical axis */
+    nvgFontFace(ctx, "sans");
+    nvgFontSize(ctx, 12.0f);
+    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
+    for (int i = 0; i <= mTickCount; ++i) {
+        float t = i / (float) mTickCount;
+        float y = std::round(mPos.y() + (1.f - t) * mSize.y()) + 0.5f;
+
+        nvgBeginPath(ctx);
+        nvgMoveTo(ctx, mPos.x(), y);
+        nvgLineTo(ctx, mPos.x() + mSize.x(), y);
+        nvgStrokeColor(ctx, Color(255, i == 0 ? 96 : 32));
+        nvgStrokeWidth(ctx, 1.0f);
+        nvgStroke(ctx);
+
+        char label[32];
+        snprintf(label, sizeof(label), "%g", mYRange.x() + t * (mYRange.y() - mYRange.x()));
+        nvgFillColor(ctx, mTheme->mTextColor);
+        nvgText(ctx, mPos.x() + 3, std::min(std::max(y, mPos.y() + 7.f), mPos.y() + mSize.y() - 7.f),
+                label, nullptr);
+    }
+}
+
+void PlotCanvas::save(Serializer &s) const {
+    GLCanvas::save(s);
+    s.set("yRange", mYRange);
+    s.set("axesVisible", mAxesVisible);
+    s.set("tickCount", mTickCount);
+}
+
+bool PlotCanvas::load(Serializer &s) {
+    if (!GLCanvas::load(s)) return false;
+    if (!s.get("yRange", mYRange)) return false;
+    if (!s.get("axesVisible", mAxesVisible)) return false;
+    if (!s.get("tickCount", mTickCount)) return false;
+    return true;
+}
+
+NAMESPACE_END(nanogui)
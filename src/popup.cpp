@@ -37,7 +37,11 @@ void Popup::performLayout(NVGcontext *ctx) {
 void Popup::refreshRelativePlacement() {
     mParentWindow->refreshRelativePlacement();
     mVisible &= mParentWindow->visibleRecursive();
-    mPos = mParentWindow->position() + mAnchorPos - Vector2i(0, mAnchorHeight);
+    Vector2i pos = mParentWindow->position() + mAnchorPos - Vector2i(0, mAnchorHeight);
+    if (pos != mPos) {
+        mPos = pos;
+        invalidateParentIndex();
+    }
 }
 
 void Popup::draw(NVGcontext* ctx) {
@@ -45,12 +45,13 @@ void PopupButton::draw(NVGcontext* ctx) {
         NVGcolor textColor =
             mTextColor.w() == 0 ? mTheme->mTextColor : mTextColor;
 
-        nvgFontSize(ctx, (mFontSize < 0 ? mTheme->mButtonFontSize : mFontSize) * 1.5f);
+        float ih = (mFontSize < 0 ? mTheme->mButtonFontSize : mFontSize) * 1.5f;
+        nvgFontSize(ctx, ih);
         nvgFontFace(ctx, "icons");
         nvgFillColor(ctx, mEnabled ? textColor : mTheme->mDisabledTextColor);
         nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_MIDDLE);
 
-        float iw = nvgTextBounds(ctx, 0, 0, icon.data(), nullptr, nullptr);
+        float iw = mTheme->mTextMetrics->textBounds(ctx, "icons", ih, icon.data());
         Vector2f iconPos(0, mPos.y() + mSize.y() * 0.5f - 1);
 
         if (mPopup->side() == Popup::Right)
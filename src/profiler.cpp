@@ -0,0 +1,177 @@
+/*
+    src/profiler.cpp -- Hierarchical per-frame profiler with Chrome trace
+    export
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/profiler.h>
+#include <nanogui/widget.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <typeinfo>
+
+#if defined(__GNUG__)
+#  include <cxxabi.h>
+#endif
+
+NAMESPACE_BEGIN(nanogui)
+
+bool Profiler::sEnabled = false;
+size_t Profiler::sCapacity = 1000000;
+uint32_t Profiler::sFrame = 0;
+std::deque<Profiler::Event> Profiler::sEvents;
+std::vector<size_t> Profiler::sStack;
+
+static double time_us() {
+    static const auto base = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - base).count();
+}
+
+void Profiler::setCapacity(size_t capacity) {
+    sCapacity = std::max(capacity, (size_t) 1);
+    if (sStack.empty()) {
+        while (sEvents.size() > sCapacity)
+            sEvents.pop_front();
+    }
+}
+
+void Profiler::beginFrame() {
+    sFrame++;
+    /* Only drop old events between top-level scopes, since the stack refers to them by index */
+    if (sStack.empty()) {
+        while (sEvents.size() > sCapacity)
+            sEvents.pop_front();
+    }
+}
+
+void Profiler::begin(const char *category, const std::string &name) {
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.start = time_us();
+    event.duration = -1;
+    event.depth = (uint32_t) sStack.size();
+    event.frame = sFrame;
+    sStack.push_back(sEvents.size());
+    sEvents.push_back(std::move(event));
+}
+
+void Profiler::end() {
+    if (sStack.empty())
+        return;
+    Event &event = sEvents[sStack.back()];
+    event.duration = time_us() - event.start;
+    sStack.pop_back();
+}
+
+std::vector<Profiler::Entry> Profiler::summary(int64_t frame) {
+    std::map<std::pair<std::string, std::string>, Entry> entries;
+    std::vector<Entry *> parents;
+
+    for (const Event &event : sEvents) {
+        if (event.duration < 0 || (frame >= 0 && event.frame != (uint32_t) frame))
+            continue;
+
+        Entry &entry = entries[std::make_pair(std::string(event.category), event.name)];
+        if (entry.count == 0) {
+            entry.name = event.name;
+            entry.category = event.category;
+        }
+        entry.count++;
+        entry.totalTime += event.duration;
+        entry.selfTime += event.duration;
+
+        /* Subtract the time from the enclosing scope (events are ordered by their start) */
+        while (parents.size() > event.depth)
+            parents.pop_back();
+        if (!parents.empty() && parents.size() == event.depth)
+            parents.back()->selfTime -= event.duration;
+        parents.push_back(&entry);
+    }
+
+    std::vector<Entry> result;
+    result.reserve(entries.size());
+    for (auto &kv : entries)
+        result.push_back(kv.second);
+    std::sort(result.begin(), result.end(),
+        [](const Entry &a, const Entry &b) { return a.totalTime > b.totalTime; });
+    return result;
+}
+
+void Profiler::clear() {
+    /* Keep the running scopes so that they can still be closed */
+    if (sStack.empty())
+        sEvents.clear();
+}
+
+static void write_json_string(std::ostream &os, const std::string &str) {
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if ((unsigned char) c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    os << buf;
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
+
+void Profiler::saveChromeTrace(const std::string &filename) {
+    std::ofstream os(filename);
+    if (!os)
+        throw std::runtime_error("Profiler::saveChromeTrace(): Could not open output file");
+
+    os << std::fixed;
+    os.precision(3);
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    for (const Event &event : sEvents) {
+        if (event.duration < 0)
+            continue;
+        os << (first ? "\n" : ",\n") << "{\"name\":";
+        write_json_string(os, event.name);
+        os << ",\"cat\":";
+        write_json_string(os, event.category);
+        os << ",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration
+           << ",\"pid\":0,\"tid\":0,\"args\":{\"frame\":" << event.frame << "}}";
+        first = false;
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+std::string Profiler::widgetName(const Widget *widget) {
+    if (!widget->id().empty())
+        return widget->id();
+
+    const char *name = typeid(*widget).name();
+#if defined(__GNUG__)
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string result(demangled);
+        free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+NAMESPACE_END(nanogui)
@@ -16,7 +16,10 @@
 #include <nanogui/opengl.h>
 #include <nanogui/window.h>
 #include <nanogui/popup.h>
+#include <nanogui/glutil.h>
+#include <nanogui/profiler.h>
 #include <map>
+#include <chrono>
 #include <iostream>
 
 #if defined(_WIN32)
@@ -31,6 +34,14 @@
 #  include <GLFW/glfw3native.h>
 #endif
 
+#if defined(NANOGUI_HEADLESS)
+/* Don't pull in the X11 headers, which clash with Eigen */
+#  define EGL_NO_X11
+#  define MESA_EGL_NO_X11_HEADERS
+#  include <EGL/egl.h>
+#  include <EGL/eglext.h>
+#endif
+
 /* Allow enforcing the GL2 implementation of NanoVG */
 #define NANOVG_GL3_IMPLEMENTATION
 #include <nanovg_gl.h>
@@ -38,6 +49,8 @@
 NAMESPACE_BEGIN(nanogui)
 
 std::map<GLFWwindow *, Screen *> __nanogui_screens;
+extern Vector4f __nanogui_clip_rect;
+extern size_t __nanogui_culled_widgets;
 
 #if defined(NANOGUI_GLAD)
 static bool gladInitialized = false;
@@ -92,7 +105,10 @@ static float get_pixel_ratio(GLFWwindow *window) {
 Screen::Screen()
     : Widget(nullptr), mGLFWWindow(nullptr), mNVGContext(nullptr),
       mCursor(Cursor::Arrow), mBackground(0.3f, 0.3f, 0.32f, 1.f),
-      mShutdownGLFWOnDestruct(false), mFullscreen(false) {
+      mShutdownGLFWOnDestruct(false), mFullscreen(false), mRedraw(true),
+      mRenderedFrames(0), mSkippedFrames(0), mCulledWidgets(0),
+      mLayoutRoots(0), mFramebuffer(nullptr), mEGLDisplay(nullptr),
+      mEGLContext(nullptr), mStartTime(0) {
     memset(mCursors, 0, sizeof(GLFWcursor *) * (int) Cursor::CursorCount);
 }
 
@@ -102,7 +118,10 @@ Screen::Screen(const Vector2i &size, const std::string &caption, bool resizable,
                unsigned int glMajor, unsigned int glMinor)
     : Widget(nullptr), mGLFWWindow(nullptr), mNVGContext(nullptr),
       mCursor(Cursor::Arrow), mBackground(0.3f, 0.3f, 0.32f, 1.f), mCaption(caption),
-      mShutdownGLFWOnDestruct(false), mFullscreen(fullscreen) {
+      mShutdownGLFWOnDestruct(false), mFullscreen(fullscreen), mRedraw(true),
+      mRenderedFrames(0), mSkippedFrames(0), mCulledWidgets(0),
+      mLayoutRoots(0), mFramebuffer(nullptr), mEGLDisplay(nullptr),
+      mEGLContext(nullptr), mStartTime(0) {
     memset(mCursors, 0, sizeof(GLFWcursor *) * (int) Cursor::CursorCount);
 
     /* Request a forward compatible OpenGL glMajor.glMinor core profile context.
@@ -258,6 +277,136 @@ Screen::Screen(const Vector2i &size, const std::string &caption, bool resizable,
     initialize(mGLFWWindow, true);
 }
 
+static double steady_time() {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Screen::Screen(const Vector2i &size, float pixelRatio,
+               unsigned int glMajor, unsigned int glMinor)
+    : Widget(nullptr), mGLFWWindow(nullptr), mNVGContext(nullptr),
+      mCursor(Cursor::Arrow), mBackground(0.3f, 0.3f, 0.32f, 1.f),
+      mShutdownGLFWOnDestruct(false), mFullscreen(false), mRedraw(true),
+      mRenderedFrames(0), mSkippedFrames(0), mCulledWidgets(0),
+      mLayoutRoots(0), mFramebuffer(nullptr), mEGLDisplay(nullptr),
+      mEGLContext(nullptr), mStartTime(steady_time()) {
+    memset(mCursors, 0, sizeof(GLFWcursor *) * (int) Cursor::CursorCount);
+
+#if defined(NANOGUI_HEADLESS)
+    /* Prefer Mesa's surfaceless platform, which neither needs a GPU nor a
+       display server. Fall back to the default display otherwise. */
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto eglGetPlatformDisplayEXT_ = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (eglGetPlatformDisplayEXT_)
+        display = eglGetPlatformDisplayEXT_(EGL_PLATFORM_SURFACELESS_MESA,
+                                            EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    /* The display is shared by all headless screens, so it is only
+       terminated on failure if no other screen has initialized it */
+    EGLint eglMajor, eglMinor;
+    if (display == EGL_NO_DISPLAY)
+        throw std::runtime_error("Could not initialize EGL!");
+    bool terminateDisplay = eglQueryString(display, EGL_VERSION) == nullptr;
+    if (!eglInitialize(display, &eglMajor, &eglMinor))
+        throw std::runtime_error("Could not initialize EGL!");
+
+    /* The destructor does not run if the constructor throws, so release
+       everything that was created so far on failure */
+    EGLContext context = EGL_NO_CONTEXT;
+    try {
+        /* Rendering takes place in a framebuffer object, hence no surface is needed */
+        const EGLint configAttribs[] = {
+            EGL_SURFACE_TYPE, 0,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint nConfigs = 0;
+        if (!eglBindAPI(EGL_OPENGL_API) ||
+            !eglChooseConfig(display, configAttribs, &config, 1, &nConfigs) ||
+            nConfigs == 0)
+            throw std::runtime_error("Could not find a suitable EGL configuration!");
+
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, (EGLint) glMajor,
+            EGL_CONTEXT_MINOR_VERSION, (EGLint) glMinor,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+            throw std::runtime_error("Could not create an OpenGL " +
+                                     std::to_string(glMajor) + "." +
+                                     std::to_string(glMinor) + " context!");
+        mEGLDisplay = display;
+        mEGLContext = context;
+
+#if defined(NANOGUI_GLAD)
+        if (!gladInitialized) {
+            gladInitialized = true;
+            if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress))
+                throw std::runtime_error("Could not initialize GLAD!");
+            glGetError(); // pull and ignore unhandled errors like GL_INVALID_ENUM
+        }
+#endif
+
+        mSize = size;
+        mPixelRatio = pixelRatio;
+        mFBSize = (size.cast<float>() * pixelRatio).cast<int>();
+
+        /* The depth/stencil attachment enables NanoVG's stencil strokes */
+        mFramebuffer = new GLFramebuffer();
+        mFramebuffer->init(mFBSize, 0);
+        mFramebuffer->bind();
+
+        int flags = NVG_STENCIL_STROKES | NVG_ANTIALIAS;
+#if !defined(NDEBUG)
+        flags |= NVG_DEBUG;
+#endif
+
+        mNVGContext = nvgCreateGL3(flags);
+        if (mNVGContext == nullptr)
+            throw std::runtime_error("Could not initialize NanoVG!");
+
+        mVisible = true;
+        setTheme(new Theme(mNVGContext));
+    } catch (...) {
+        if (mNVGContext) {
+            nvgDeleteGL3(mNVGContext);
+            mNVGContext = nullptr;
+        }
+        if (mFramebuffer) {
+            mFramebuffer->free();
+            delete mFramebuffer;
+            mFramebuffer = nullptr;
+        }
+        if (context != EGL_NO_CONTEXT) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+        if (terminateDisplay)
+            eglTerminate(display);
+        mEGLDisplay = mEGLContext = nullptr;
+        throw;
+    }
+
+    mMousePos = Vector2i::Zero();
+    mMouseState = mModifiers = 0;
+    mDragActive = false;
+    mLastInteraction = time();
+    mProcessEvents = true;
+#else
+    (void) size; (void) pixelRatio; (void) glMajor; (void) glMinor;
+    throw std::runtime_error("Headless screens require NanoGUI to be compiled "
+                             "with NANOGUI_HEADLESS!");
+#endif
+}
+
 void Screen::initialize(GLFWwindow *window, bool shutdownGLFWOnDestruct) {
     mGLFWWindow = window;
     mShutdownGLFWOnDestruct = shutdownGLFWOnDestruct;
@@ -304,7 +453,7 @@ void Screen::initialize(GLFWwindow *window, bool shutdownGLFWOnDestruct) {
     mMousePos = Vector2i::Zero();
     mMouseState = mModifiers = 0;
     mDragActive = false;
-    mLastInteraction = glfwGetTime();
+    mLastInteraction = time();
     mProcessEvents = true;
     __nanogui_screens[mGLFWWindow] = this;
 
@@ -313,13 +462,31 @@ void Screen::initialize(GLFWwindow *window, bool shutdownGLFWOnDestruct) {
 }
 
 Screen::~Screen() {
-    __nanogui_screens.erase(mGLFWWindow);
+    if (mGLFWWindow)
+        __nanogui_screens.erase(mGLFWWindow);
     for (int i=0; i < (int) Cursor::CursorCount; ++i) {
         if (mCursors[i])
             glfwDestroyCursor(mCursors[i]);
     }
+#if defined(NANOGUI_HEADLESS)
+    if (mEGLContext)
+        eglMakeCurrent((EGLDisplay) mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       (EGLContext) mEGLContext);
+#endif
     if (mNVGContext)
         nvgDeleteGL3(mNVGContext);
+    if (mFramebuffer) {
+        mFramebuffer->free();
+        delete mFramebuffer;
+    }
+#if defined(NANOGUI_HEADLESS)
+    /* The display is shared by all headless screens and stays initialized */
+    if (mEGLContext) {
+        eglMakeCurrent((EGLDisplay) mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                       EGL_NO_CONTEXT);
+        eglDestroyContext((EGLDisplay) mEGLDisplay, (EGLContext) mEGLContext);
+    }
+#endif
     if (mGLFWWindow && mShutdownGLFWOnDestruct)
         glfwDestroyWindow(mGLFWWindow);
 }
@@ -327,7 +494,10 @@ Screen::~Screen() {
 void Screen::setVisible(bool visible) {
     if (mVisible != visible) {
         mVisible = visible;
+        mRedraw = true;
 
+        if (!mGLFWWindow)
+            return;
         if (visible)
             glfwShowWindow(mGLFWWindow);
         else
@@ -337,13 +507,22 @@ void Screen::setVisible(bool visible) {
 
 void Screen::setCaption(const std::string &caption) {
     if (caption != mCaption) {
-        glfwSetWindowTitle(mGLFWWindow, caption.c_str());
+        if (mGLFWWindow)
+            glfwSetWindowTitle(mGLFWWindow, caption.c_str());
         mCaption = caption;
     }
 }
 
 void Screen::setSize(const Vector2i &size) {
     Widget::setSize(size);
+    mRedraw = true;
+
+    if (!mGLFWWindow) {
+        /* Headless screens have no window that could report the new size */
+        Vector2i fbSize = (size.cast<float>() * mPixelRatio).cast<int>();
+        resizeCallbackEvent(fbSize.x(), fbSize.y());
+        return;
+    }
 
 #if defined(_WIN32) || defined(__linux__)
     glfwSetWindowSize(mGLFWWindow, size.x() * mPixelRatio, size.y() * mPixelRatio);
@@ -352,46 +531,127 @@ void Screen::setSize(const Vector2i &size) {
 #endif
 }
 
+void Screen::updateLayout() {
+    NANOGUI_PROFILE_SCOPE("layout", "updateLayout");
+    std::vector<Widget *> roots;
+    collectLayoutRoots(roots);
+    for (auto root : roots) {
+        NANOGUI_PROFILE_WIDGET("layout", root);
+        root->performLayout(mNVGContext);
+    }
+    clearLayoutDirty();
+    mLayoutRoots = roots.size();
+}
+
 void Screen::drawAll() {
+#if defined(NANOGUI_PROFILE)
+    Profiler::beginFrame();
+#endif
+    NANOGUI_PROFILE_SCOPE("frame", "drawAll");
+    updateLayout();
+
+    /* Clear the flag first so that drawing code may request another frame */
+    mRedraw = false;
+    mRenderedFrames++;
+
+    makeContextCurrent();
     glClearColor(mBackground[0], mBackground[1], mBackground[2], mBackground[3]);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-    drawContents();
+    {
+        NANOGUI_PROFILE_SCOPE("draw", "drawContents");
+        drawContents();
+    }
     drawWidgets();
 
-    glfwSwapBuffers(mGLFWWindow);
+    NANOGUI_PROFILE_SCOPE("gl", "swapBuffers");
+    if (mGLFWWindow)
+        glfwSwapBuffers(mGLFWWindow);
+    else
+        glFinish(); /* Account for the rendering time like a buffer swap would */
+}
+
+void Screen::redraw() {
+    if (!mRedraw.exchange(true) && mGLFWWindow)
+        glfwPostEmptyEvent();
+}
+
+void Screen::makeContextCurrent() {
+    if (mGLFWWindow) {
+        glfwMakeContextCurrent(mGLFWWindow);
+        return;
+    }
+#if defined(NANOGUI_HEADLESS)
+    eglMakeCurrent((EGLDisplay) mEGLDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   (EGLContext) mEGLContext);
+#endif
+    /* drawContents() may have bound other framebuffers */
+    if (mFramebuffer)
+        mFramebuffer->bind();
+}
+
+double Screen::time() const {
+    if (mGLFWWindow)
+        return glfwGetTime();
+    return steady_time() - mStartTime;
+}
+
+void Screen::downloadPixels(std::vector<uint8_t> &rgba) {
+    if (!mFramebuffer)
+        throw std::runtime_error("Screen::downloadPixels(): only supported by headless screens!");
+    makeContextCurrent();
+    rgba.resize((size_t) mFBSize.prod() * 4);
+    mFramebuffer->downloadPixels(rgba.data());
+}
+
+void Screen::downloadTGA(const std::string &filename) {
+    if (!mFramebuffer)
+        throw std::runtime_error("Screen::downloadTGA(): only supported by headless screens!");
+    makeContextCurrent();
+    mFramebuffer->downloadTGA(filename);
 }
 
 void Screen::drawWidgets() {
     if (!mVisible)
         return;
 
-    glfwMakeContextCurrent(mGLFWWindow);
+    NANOGUI_PROFILE_SCOPE("draw", "drawWidgets");
+    makeContextCurrent();
 
-    glfwGetFramebufferSize(mGLFWWindow, &mFBSize[0], &mFBSize[1]);
-    glfwGetWindowSize(mGLFWWindow, &mSize[0], &mSize[1]);
+    if (mGLFWWindow) {
+        glfwGetFramebufferSize(mGLFWWindow, &mFBSize[0], &mFBSize[1]);
+        glfwGetWindowSize(mGLFWWindow, &mSize[0], &mSize[1]);
 
 #if defined(_WIN32) || defined(__linux__)
-    mSize = (mSize / mPixelRatio).cast<int>();
-    mFBSize = (mSize * mPixelRatio).cast<int>();
+        mSize = (mSize / mPixelRatio).cast<int>();
+        mFBSize = (mSize * mPixelRatio).cast<int>();
 #else
-    /* Recompute pixel ratio on OSX */
-    if (mSize[0])
-        mPixelRatio = (float) mFBSize[0] / (float) mSize[0];
+        /* Recompute pixel ratio on OSX */
+        if (mSize[0])
+            mPixelRatio = (float) mFBSize[0] / (float) mSize[0];
 #endif
+    }
 
     glViewport(0, 0, mFBSize[0], mFBSize[1]);
     glBindSampler(0, 0);
     nvgBeginFrame(mNVGContext, mSize[0], mSize[1], mPixelRatio);
 
+    __nanogui_clip_rect = Vector4f(0, 0, mSize[0], mSize[1]);
+    __nanogui_culled_widgets = 0;
     draw(mNVGContext);
+    mCulledWidgets = __nanogui_culled_widgets;
+
+    double elapsed = time() - mLastInteraction;
 
-    double elapsed = glfwGetTime() - mLastInteraction;
+    /* Draw tooltips */
+    const Widget *widget = findWidget(mMousePos);
+    if (widget && !widget->tooltip().empty()) {
+        NANOGUI_PROFILE_SCOPE("draw", "tooltip");
+        /* Keep redrawing until the tooltip has fully faded in */
+        if (elapsed < 1.0f)
+            mRedraw = true;
 
-    if (elapsed > 0.5f) {
-        /* Draw tooltips */
-        const Widget *widget = findWidget(mMousePos);
-        if (widget && !widget->tooltip().empty()) {
+        if (elapsed > 0.5f) {
             int tooltipWidth = 150;
 
             float bounds[4];
@@ -434,6 +694,7 @@ void Screen::drawWidgets() {
         }
     }
 
+    NANOGUI_PROFILE_SCOPE("gl", "nvgEndFrame");
     nvgEndFrame(mNVGContext);
 }
 
@@ -457,6 +718,7 @@ bool Screen::keyboardCharacterEvent(unsigned int codepoint) {
 }
 
 bool Screen::cursorPosCallbackEvent(double x, double y) {
+    NANOGUI_PROFILE_SCOPE("event", "cursorPos");
     Vector2i p((int) x, (int) y);
 
 #if defined(_WIN32) || defined(__linux__)
@@ -464,7 +726,8 @@ bool Screen::cursorPosCallbackEvent(double x, double y) {
 #endif
 
     bool ret = false;
-    mLastInteraction = glfwGetTime();
+    mLastInteraction = time();
+    mRedraw = true;
     try {
         p -= Vector2i(1, 2);
 
@@ -472,7 +735,8 @@ bool Screen::cursorPosCallbackEvent(double x, double y) {
             Widget *widget = findWidget(p);
             if (widget != nullptr && widget->cursor() != mCursor) {
                 mCursor = widget->cursor();
-                glfwSetCursor(mGLFWWindow, mCursors[(int) mCursor]);
+                if (mGLFWWindow)
+                    glfwSetCursor(mGLFWWindow, mCursors[(int) mCursor]);
             }
         } else {
             ret = mDragWidget->mouseDragEvent(
@@ -493,8 +757,10 @@ bool Screen::cursorPosCallbackEvent(double x, double y) {
 }
 
 bool Screen::mouseButtonCallbackEvent(int button, int action, int modifiers) {
+    NANOGUI_PROFILE_SCOPE("event", "mouseButton");
     mModifiers = modifiers;
-    mLastInteraction = glfwGetTime();
+    mLastInteraction = time();
+    mRedraw = true;
     try {
         if (mFocusPath.size() > 1) {
             const Window *window =
@@ -519,7 +785,8 @@ bool Screen::mouseButtonCallbackEvent(int button, int action, int modifiers) {
 
         if (dropWidget != nullptr && dropWidget->cursor() != mCursor) {
             mCursor = dropWidget->cursor();
-            glfwSetCursor(mGLFWWindow, mCursors[(int) mCursor]);
+            if (mGLFWWindow)
+                glfwSetCursor(mGLFWWindow, mCursors[(int) mCursor]);
         }
 
         if (action == GLFW_PRESS && (button == GLFW_MOUSE_BUTTON_1 || button == GLFW_MOUSE_BUTTON_2)) {
@@ -543,7 +810,9 @@ bool Screen::mouseButtonCallbackEvent(int button, int action, int modifiers) {
 }
 
 bool Screen::keyCallbackEvent(int key, int scancode, int action, int mods) {
-    mLastInteraction = glfwGetTime();
+    NANOGUI_PROFILE_SCOPE("event", "key");
+    mLastInteraction = time();
+    mRedraw = true;
     try {
         return keyboardEvent(key, scancode, action, mods);
     } catch (const std::exception &e) {
@@ -553,7 +822,9 @@ bool Screen::keyCallbackEvent(int key, int scancode, int action, int mods) {
 }
 
 bool Screen::charCallbackEvent(unsigned int codepoint) {
-    mLastInteraction = glfwGetTime();
+    NANOGUI_PROFILE_SCOPE("event", "char");
+    mLastInteraction = time();
+    mRedraw = true;
     try {
         return keyboardCharacterEvent(codepoint);
     } catch (const std::exception &e) {
@@ -564,14 +835,18 @@ bool Screen::charCallbackEvent(unsigned int codepoint) {
 }
 
 bool Screen::dropCallbackEvent(int count, const char **filenames) {
+    NANOGUI_PROFILE_SCOPE("event", "drop");
     std::vector<std::string> arg(count);
     for (int i = 0; i < count; ++i)
         arg[i] = filenames[i];
+    mRedraw = true;
     return dropEvent(arg);
 }
 
 bool Screen::scrollCallbackEvent(double x, double y) {
-    mLastInteraction = glfwGetTime();
+    NANOGUI_PROFILE_SCOPE("event", "scroll");
+    mLastInteraction = time();
+    mRedraw = true;
     try {
         if (mFocusPath.size() > 1) {
             const Window *window =
@@ -589,23 +864,44 @@ bool Screen::scrollCallbackEvent(double x, double y) {
     }
 }
 
-bool Screen::resizeCallbackEvent(int, int) {
+bool Screen::resizeCallbackEvent(int width, int height) {
+    NANOGUI_PROFILE_SCOPE("event", "resize");
     Vector2i fbSize, size;
-    glfwGetFramebufferSize(mGLFWWindow, &fbSize[0], &fbSize[1]);
-    glfwGetWindowSize(mGLFWWindow, &size[0], &size[1]);
+    if (mGLFWWindow) {
+        glfwGetFramebufferSize(mGLFWWindow, &fbSize[0], &fbSize[1]);
+        glfwGetWindowSize(mGLFWWindow, &size[0], &size[1]);
 
 #if defined(_WIN32) || defined(__linux__)
-    size /= mPixelRatio;
+        size /= mPixelRatio;
 #endif
+    } else {
+        fbSize = Vector2i(width, height);
+        size = (fbSize.cast<float>() / mPixelRatio).cast<int>();
+    }
 
     if (mFBSize == Vector2i(0, 0) || size == Vector2i(0, 0))
         return false;
 
+    if (mFramebuffer && fbSize != mFBSize) {
+        /* Reallocate the offscreen render target */
+        makeContextCurrent();
+        mFramebuffer->free();
+        mFramebuffer->init(fbSize, 0);
+    }
+
     mFBSize = fbSize; mSize = size;
-    mLastInteraction = glfwGetTime();
+    mLastInteraction = time();
+    mRedraw = true;
+
+    /* Only maximized windows depend on the size of the screen */
+    for (auto child : mChildren) {
+        Window *window = dynamic_cast<Window *>(child);
+        if (window && window->maximized())
+            window->setSize(mSize);
+    }
 
     try {
-        performLayout(mNVGContext);
+        updateLayout();
         return resizeEvent(mSize);
     } catch (const std::exception &e) {
         std::cerr << "Caught exception in event handler: " << e.what()
@@ -645,7 +941,7 @@ void Screen::disposeWindow(Window *window) {
 
 void Screen::centerWindow(Window *window) {
     if (window->size() == Vector2i::Zero()) {
-        window->setSize(window->preferredSize(mNVGContext));
+        window->setSize(window->cachedPreferredSize(mNVGContext));
         window->performLayout(mNVGContext);
     }
     window->setPosition((mSize - window->size()) / 2);
@@ -654,6 +950,7 @@ void Screen::centerWindow(Window *window) {
 void Screen::moveWindowToFront(Window *window) {
     mChildren.erase(std::remove(mChildren.begin(), mChildren.end(), window), mChildren.end());
     mChildren.push_back(window);
+    mSpatialIndexValid = false;
     /* Brute force topological sort (no problem for a few windows..) */
     bool changed = false;
     do {
@@ -0,0 +1,172 @@
+/*
+    src/sparklinegrid.cpp -- Grid of small function plots drawn with
+    a few batched NanoVG paths
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/sparklinegrid.h>
+#include <nanogui/graph.h>
+#include <nanogui/theme.h>
+#include <nanogui/textmetrics.h>
+#include <nanogui/opengl.h>
+#include <nanogui/serializer/core.h>
+
+NAMESPACE_BEGIN(nanogui)
+
+SparklineGrid::SparklineGrid(Widget *parent)
+    : Widget(parent), mColumns(4), mCellSize(180, 45), mSpacing(4) {
+    mBackgroundColor = Color(20, 128);
+    mForegroundColor = Color(255, 192, 0, 128);
+    mTextColor = Color(240, 192);
+}
+
+int SparklineGrid::addSeries(const std::string &caption) {
+    Series series;
+    series.caption = caption;
+    mSeries.push_back(series);
+    invalidatePreferredSize();
+    markDirty();
+    return (int) mSeries.size() - 1;
+}
+
+Vector2i SparklineGrid::preferredSize(NVGcontext *) const {
+    int count = std::max((int) mSeries.size(), 1);
+    Vector2i cells(std::min(count, mColumns), (count + mColumns - 1) / mColumns);
+    return cells.cwiseProduct(mCellSize + Vector2i::Constant(mSpacing)) -
+           Vector2i::Constant(mSpacing);
+}
+
+void SparklineGrid::addPlot(NVGcontext *ctx, const VectorXf &values, const Vector2f &pos) const {
+    size_t count = (size_t) values.size();
+    if (count < 2)
+        return;
+
+    float width = (float) mCellSize.x(), height = (float) mCellSize.y();
+    auto vy = [&](float value) { return pos.y() + (1-value) * height; };
+
+    nvgMoveTo(ctx, pos.x(), pos.y() + height);
+    Graph::traceSeries(0, count, 0.0, width / (double) (count - 1),
+        [&](size_t i) { return values[i]; },
+        [&](size_t i0, size_t i1, float &min, float &max) {
+            auto segment = values.segment((Eigen::DenseIndex) i0, (Eigen::DenseIndex) (i1 - i0));
+            min = segment.minCoeff();
+            max = segment.maxCoeff();
+        },
+        [&](float x, float value) { nvgLineTo(ctx, pos.x() + x, vy(value)); });
+    nvgLineTo(ctx, pos.x() + width, pos.y() + height);
+}
+
+void SparklineGrid::drawTexts(NVGcontext *ctx, bool headers) const {
+    const std::string font = "sans";
+    float fontSize = headers ? 18.0f : 14.0f;
+    nvgFontFace(ctx, font.c_str());
+    nvgFontSize(ctx, fontSize);
+    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
+    nvgFillColor(ctx, mTextColor);
+
+    float available = (float) (mCellSize.x() - 6);
+    for (size_t i = 0; i < mSeries.size(); ++i) {
+        const std::string &text = headers ? mSeries[i].header : mSeries[i].caption;
+        if (text.empty())
+            continue;
+        Vector2f pos = (mPos + cellPosition((int) i)).cast<float>();
+
+        /* The cached width right-aligns headers without letting NanoVG
+           measure the text again in every frame, and tells which texts
+           would spill into the neighboring cells */
+        float advance = mTheme->mTextMetrics->textBounds(ctx, font, fontSize, text);
+        float x = headers ? pos.x() + mCellSize.x() - 3 - advance : pos.x() + 3;
+        bool clip = advance > available;
+        if (clip) {
+            nvgSave(ctx);
+            nvgIntersectScissor(ctx, pos.x(), pos.y(), mCellSize.x(), mCellSize.y());
+        }
+        nvgText(ctx, x, pos.y() + 1, text.c_str(), nullptr);
+        if (clip)
+            nvgRestore(ctx);
+    }
+}
+
+void SparklineGrid::draw(NVGcontext *ctx) {
+    Widget::draw(ctx);
+    if (mSeries.empty())
+        return;
+
+    /* Backgrounds */
+    nvgBeginPath(ctx);
+    for (size_t i = 0; i < mSeries.size(); ++i) {
+        Vector2i pos = mPos + cellPosition((int) i);
+        nvgRect(ctx, pos.x(), pos.y(), mCellSize.x(), mCellSize.y());
+    }
+    nvgFillColor(ctx, mBackgroundColor);
+    nvgFill(ctx);
+
+    /* Plots, as one path with a subpath per series */
+    nvgBeginPath(ctx);
+    for (size_t i = 0; i < mSeries.size(); ++i)
+        addPlot(ctx, mSeries[i].values, (mPos + cellPosition((int) i)).cast<float>());
+    nvgStrokeColor(ctx, Color(100, 255));
+    nvgStroke(ctx);
+    nvgFillColor(ctx, mForegroundColor);
+    nvgFill(ctx);
+
+    drawTexts(ctx, false);
+    drawTexts(ctx, true);
+
+    /* Borders */
+    nvgBeginPath(ctx);
+    for (size_t i = 0; i < mSeries.size(); ++i) {
+        Vector2i pos = mPos + cellPosition((int) i);
+        nvgRect(ctx, pos.x(), pos.y(), mCellSize.x(), mCellSize.y());
+    }
+    nvgStrokeColor(ctx, Color(100, 255));
+    nvgStroke(ctx);
+}
+
+void SparklineGrid::save(Serializer &s) const {
+    Widget::save(s);
+    s.set("columns", mColumns);
+    s.set("cellSize", mCellSize);
+    s.set("spacing", mSpacing);
+    s.set("backgroundColor", mBackgroundColor);
+    s.set("foregroundColor", mForegroundColor);
+    s.set("textColor", mTextColor);
+    s.set("seriesCount", (int) mSeries.size());
+    for (size_t i = 0; i < mSeries.size(); ++i) {
+        s.push("series" + std::to_string(i));
+        s.set("caption", mSeries[i].caption);
+        s.set("header", mSeries[i].header);
+        s.set("values", mSeries[i].values);
+        s.pop();
+    }
+}
+
+bool SparklineGrid::load(Serializer &s) {
+    if (!Widget::load(s)) return false;
+    if (!s.get("columns", mColumns)) return false;
+    if (!s.get("cellSize", mCellSize)) return false;
+    if (!s.get("spacing", mSpacing)) return false;
+    if (!s.get("backgroundColor", mBackgroundColor)) return false;
+    if (!s.get("foregroundColor", mForegroundColor)) return false;
+    if (!s.get("textColor", mTextColor)) return false;
+    int count;
+    if (!s.get("seriesCount", count)) return false;
+    mSeries.resize(count);
+    for (int i = 0; i < count; ++i) {
+        s.push("series" + std::to_string(i));
+        bool ok = s.get("caption", mSeries[i].caption) &&
+                  s.get("header", mSeries[i].header) &&
+                  s.get("values", mSeries[i].values);
+        s.pop();
+        if (!ok) return false;
+    }
+    return true;
+}
+
+NAMESPACE_END(nanogui)
@@ -0,0 +1,145 @@
+/*
+    src/spatialgrid.cpp -- Uniform grid over the child widgets of a
+    container, used to accelerate hit testing
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/spatialgrid.h>
+#include <nanogui/widget.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+NAMESPACE_BEGIN(nanogui)
+
+/* Upper bound on the number of cells along each axis */
+static const int max_resolution = 1024;
+
+SpatialGrid::SpatialGrid()
+    : mOrigin(Vector2i::Zero()), mCellSize(Vector2i::Ones()),
+      mResolution(Vector2i::Zero()) { }
+
+void SpatialGrid::build(const std::vector<Widget *> &children) {
+    mCellStart.clear();
+    mItems.clear();
+    mResolution = Vector2i::Zero();
+
+    /* Bounding box of all children that can possibly contain a point */
+    Vector2i minPos(INT_MAX, INT_MAX), maxPos(INT_MIN, INT_MIN);
+    int count = 0;
+    for (auto child : children) {
+        if (child->width() <= 0 || child->height() <= 0)
+            continue;
+        minPos = minPos.cwiseMin(child->position());
+        maxPos = maxPos.cwiseMax(child->position() + child->size());
+        count++;
+    }
+    if (count == 0)
+        return;
+
+    /* Aim for roughly one child per cell, with approximately square cells */
+    Vector2i extent = maxPos - minPos;
+    float aspect = extent.x() / (float) extent.y();
+    int nx = std::max(1, std::min(max_resolution,
+                 (int) std::ceil(std::sqrt(count * aspect))));
+    int ny = std::max(1, std::min(max_resolution,
+                 (int) std::ceil(count / (float) nx)));
+
+    mOrigin = minPos;
+    mCellSize = Vector2i(
+        std::max(1, (extent.x() + nx - 1) / nx),
+        std::max(1, (extent.y() + ny - 1) / ny));
+    mResolution = Vector2i(
+        (extent.x() + mCellSize.x() - 1) / mCellSize.x(),
+        (extent.y() + mCellSize.y() - 1) / mCellSize.y());
+
+    /* Two passes: count the entries of each cell, then scatter the child
+       indices. Children are visited in order, hence each cell ends up with
+       a sorted index list. */
+    int cellCount = mResolution.x() * mResolution.y();
+    mCellStart.assign(cellCount + 1, 0);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<uint32_t> fill;
+        if (pass == 1) {
+            for (int i = 0; i < cellCount; ++i)
+                mCellStart[i + 1] += mCellStart[i];
+            mItems.resize(mCellStart[cellCount]);
+            fill.assign(mCellStart.begin(), mCellStart.end() - 1);
+        }
+
+        for (size_t index = 0; index < children.size(); ++index) {
+            const Widget *child = children[index];
+            if (child->width() <= 0 || child->height() <= 0)
+                continue;
+            Vector2i lo = (child->position() - mOrigin).cwiseQuotient(mCellSize);
+            Vector2i hi = (child->position() + child->size() - Vector2i::Ones() - mOrigin)
+                              .cwiseQuotient(mCellSize);
+            for (int y = lo.y(); y <= hi.y(); ++y) {
+                for (int x = lo.x(); x <= hi.x(); ++x) {
+                    int cell = y * mResolution.x() + x;
+                    if (pass == 0)
+                        mCellStart[cell + 1]++;
+                    else
+                        mItems[fill[cell]++] = (uint32_t) index;
+                }
+            }
+        }
+    }
+}
+
+int SpatialGrid::cellIndex(const Vector2i &p) const {
+    Vector2i cell = p - mOrigin;
+    if ((cell.array() < 0).any())
+        return -1;
+    cell = cell.cwiseQuotient(mCellSize);
+    if ((cell.array() >= mResolution.array()).any())
+        return -1;
+    return cell.y() * mResolution.x() + cell.x();
+}
+
+const std::vector<Widget *> &SpatialGrid::query(const Vector2i &p0, const Vector2i &p1,
+                                                const std::vector<Widget *> &children) {
+    mResult.clear();
+
+    int cell0 = cellIndex(p0), cell1 = cellIndex(p1);
+    if (cell0 == cell1)
+        cell1 = -1;
+    if (cell0 < 0)
+        std::swap(cell0, cell1);
+    if (cell0 < 0)
+        return mResult;
+
+    const uint32_t *a = mItems.data() + mCellStart[cell0],
+                   *aEnd = mItems.data() + mCellStart[cell0 + 1],
+                   *b = nullptr, *bEnd = nullptr;
+    if (cell1 >= 0) {
+        b = mItems.data() + mCellStart[cell1];
+        bEnd = mItems.data() + mCellStart[cell1 + 1];
+    }
+
+    /* Merge the (sorted) index lists of both cells */
+    while (a != aEnd || b != bEnd) {
+        uint32_t index;
+        if (b == bEnd || (a != aEnd && *a < *b)) {
+            index = *a++;
+        } else if (a == aEnd || *b < *a) {
+            index = *b++;
+        } else {
+            index = *a++;
+            ++b;
+        }
+        if (index < children.size())
+            mResult.push_back(children[index]);
+    }
+
+    return mResult;
+}
+
+NAMESPACE_END(nanogui)
@@ -42,7 +42,7 @@ void StackedWidget::performLayout(NVGcontext *ctx) {
 Vector2i StackedWidget::preferredSize(NVGcontext *ctx) const {
     Vector2i size = Vector2i::Zero();
     for (auto child : mChildren)
-        size = size.cwiseMax(child->preferredSize(ctx));
+        size = size.cwiseMax(child->cachedPreferredSize(ctx));
     return size;
 }
 
@@ -0,0 +1,191 @@
+/*
+    src/streamingtexture.cpp -- Texture receiving frames from a producer
+    thread through a ring of mapped pixel buffer objects
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/streamingtexture.h>
+#include <nanogui/screen.h>
+#include <cstring>
+#include <stdexcept>
+
+NAMESPACE_BEGIN(nanogui)
+
+StreamingTexture::StreamingTexture(const Vector2i &size, int buffers)
+    : mSize(size), mBytes((size_t) size.x() * (size_t) size.y() * 4),
+      mSlotCount(std::max(buffers, 2)), mSlots(new Slot[mSlotCount]) {
+    glGenTextures(2, mTextures);
+    for (int i = 0; i < 2; ++i) {
+        glBindTexture(GL_TEXTURE_2D, mTextures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x(), size.y(), 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (int i = 0; i < mSlotCount; ++i) {
+        Slot &slot = mSlots[i];
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) mBytes, nullptr, GL_STREAM_DRAW);
+        map(slot);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+StreamingTexture::~StreamingTexture() {
+    for (int i = 0; i < mSlotCount; ++i) {
+        Slot &slot = mSlots[i];
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        if (slot.data) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glDeleteBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteTextures(2, mTextures);
+}
+
+void StreamingTexture::map(Slot &slot) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    slot.data = (uint8_t *) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr) mBytes,
+                                             GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!slot.data)
+        throw std::runtime_error("StreamingTexture: could not map pixel buffer object!");
+    slot.state.store(Free, std::memory_order_release);
+}
+
+uint8_t *StreamingTexture::beginFrame() {
+    /* Prefer a free buffer, and otherwise overwrite the oldest frame that
+       the OpenGL thread has not started to upload yet */
+    Slot *oldest = nullptr;
+    for (int i = 0; i < mSlotCount; ++i) {
+        Slot &slot = mSlots[i];
+        int state = Free;
+        if (slot.state.compare_exchange_strong(state, Writing, std::memory_order_acquire)) {
+            mWriting = &slot;
+            return slot.data;
+        }
+        if (state == Filled && (!oldest || slot.sequence < oldest->sequence))
+            oldest = &slot;
+    }
+    mDroppedCount++;
+    int state = Filled;
+    if (oldest && oldest->state.compare_exchange_strong(state, Writing, std::memory_order_acquire)) {
+        mWriting = oldest;
+        return oldest->data;
+    }
+    return nullptr;
+}
+
+void StreamingTexture::endFrame() {
+    if (!mWriting)
+        return;
+    mWriting->sequence = ++mSequence;
+    mWriting->state.store(Filled, std::memory_order_release);
+    mWriting = nullptr;
+    mPushedCount++;
+
+    std::lock_guard<std::mutex> guard(mScreenMutex);
+    if (mScreen)
+        mScreen->redraw();
+}
+
+void StreamingTexture::setScreen(Screen *screen) {
+    std::lock_guard<std::mutex> guard(mScreenMutex);
+    mScreen = screen;
+}
+
+bool StreamingTexture::pushFrame(const uint8_t *rgba) {
+    uint8_t *data = beginFrame();
+    if (!data)
+        return false;
+    memcpy(data, rgba, mBytes);
+    endFrame();
+    return true;
+}
+
+GLuint StreamingTexture::update() {
+    /* Present the frame uploaded during a previous call once its transfer is done */
+    if (mUploading >= 0) {
+        Slot &slot = mSlots[mUploading];
+        GLenum result = glClientWaitSync(slot.fence, 0, 0);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+            mFront = mFront < 0 ? 0 : 1 - mFront;
+            mShownCount++;
+            map(slot);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            mUploading = -1;
+        } else if (!mUploadLate) {
+            mUploadLate = true;
+            mLateCount++;
+        }
+    }
+
+    /* Start uploading the newest complete frame, discarding older ones */
+    if (mUploading < 0) {
+        int newest = -1;
+        for (int i = 0; i < mSlotCount; ++i) {
+            if (mSlots[i].state.load(std::memory_order_acquire) == Filled &&
+                (newest < 0 || mSlots[i].sequence > mSlots[newest].sequence))
+                newest = i;
+        }
+        int state = Filled;
+        if (newest >= 0 && mSlots[newest].state.compare_exchange_strong(state, Uploading, std::memory_order_acquire)) {
+            /* Claim each other complete frame before checking its age, since
+               the producer may publish a newer frame in the meantime */
+            for (int i = 0; i < mSlotCount; ++i) {
+                state = Filled;
+                if (i == newest || !mSlots[i].state.compare_exchange_strong(state, Uploading, std::memory_order_acquire))
+                    continue;
+                if (mSlots[i].sequence < mSlots[newest].sequence) {
+                    mSlots[i].state.store(Free, std::memory_order_release);
+                    mDroppedCount++;
+                } else {
+                    mSlots[i].state.store(Filled, std::memory_order_release);
+                }
+            }
+
+            Slot &slot = mSlots[newest];
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            slot.data = nullptr;
+            slot.state = Unmapped;
+            glBindTexture(GL_TEXTURE_2D, mTextures[mFront < 0 ? 0 : 1 - mFront]);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mSize.x(), mSize.y(),
+                            GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+            mUploading = newest;
+            mUploadLate = false;
+        }
+    }
+
+    return mFront < 0 ? 0 : mTextures[mFront];
+}
+
+bool StreamingTexture::framePending() const {
+    if (mUploading >= 0)
+        return true;
+    for (int i = 0; i < mSlotCount; ++i)
+        if (mSlots[i].state.load(std::memory_order_acquire) == Filled)
+            return true;
+    return false;
+}
+
+NAMESPACE_END(nanogui)
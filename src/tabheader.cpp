@@ -23,9 +23,9 @@ TabHeader::TabButton::TabButton(TabHeader &header, const std::string &label)
     : mHeader(&header), mLabel(label) { }
 
 Vector2i TabHeader::TabButton::preferredSize(NVGcontext *ctx) const {
-    // No need to call nvg font related functions since this is done by the tab header implementation
     float bounds[4];
-    int labelWidth = nvgTextBounds(ctx, 0, 0, mLabel.c_str(), nullptr, bounds);
+    int labelWidth = mHeader->theme()->mTextMetrics->textBounds(
+        ctx, mHeader->font(), mHeader->fontSize(), mLabel, bounds);
     int buttonWidth = labelWidth + 2 * mHeader->theme()->mTabButtonHorizontalPadding;
     int buttonHeight = bounds[3] - bounds[1] + 2 * mHeader->theme()->mTabButtonVerticalPadding;
     return Vector2i(buttonWidth, buttonHeight);
@@ -153,6 +153,7 @@ TabHeader::TabHeader(Widget* parent, const std::string& font)
 void TabHeader::setActiveTab(int tabIndex) {
     assert(tabIndex < tabCount());
     mActiveTab = tabIndex;
+    markDirty();
     if (mCallback)
         mCallback(tabIndex);
 }
@@ -172,6 +173,7 @@ void TabHeader::addTab(const std::string & label) {
 void TabHeader::addTab(int index, const std::string &label) {
     assert(index <= tabCount());
     mTabButtons.insert(std::next(mTabButtons.begin(), index), TabButton(*this, label));
+    invalidatePreferredSize();
     setActiveTab(index);
 }
 
@@ -182,6 +184,7 @@ int TabHeader::removeTab(const std::string &label) {
     if (element == mTabButtons.end())
         return -1;
     mTabButtons.erase(element);
+    invalidatePreferredSize();
     if (index == mActiveTab && index != 0)
         setActiveTab(index - 1);
     return index;
@@ -190,6 +193,7 @@ int TabHeader::removeTab(const std::string &label) {
 void TabHeader::removeTab(int index) {
     assert(index < tabCount());
     mTabButtons.erase(std::next(mTabButtons.begin(), index));
+    invalidatePreferredSize();
     if (index == mActiveTab && index != 0)
         setActiveTab(index - 1);
 }
@@ -283,6 +287,11 @@ std::pair<Vector2i, Vector2i> TabHeader::activeButtonArea() const {
 void TabHeader::performLayout(NVGcontext* ctx) {
     Widget::performLayout(ctx);
 
+    // Set up the nvg context for truncating the text inside the tab buttons.
+    nvgFontFace(ctx, mFont.c_str());
+    nvgFontSize(ctx, fontSize());
+    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
+
     Vector2i currentPosition = Vector2i::Zero();
     // Place the tab buttons relative to the beginning of the tab header.
     for (auto& tab : mTabButtons) {
@@ -301,10 +310,6 @@ void TabHeader::performLayout(NVGcontext* ctx) {
 }
 
 Vector2i TabHeader::preferredSize(NVGcontext* ctx) const {
-    // Set up the nvg context for measuring the text inside the tab buttons.
-    nvgFontFace(ctx, mFont.c_str());
-    nvgFontSize(ctx, fontSize());
-    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
     Vector2i size = Vector2i(2*theme()->mTabControlWidth, 0);
     for (auto& tab : mTabButtons) {
         auto tabPreferred = tab.preferredSize(ctx);
@@ -61,6 +61,7 @@ void TextBox::setTheme(Theme *theme) {
 
 Vector2i TextBox::preferredSize(NVGcontext *ctx) const {
     Vector2i size(0, fontSize() * 1.4f);
+    const TextMetrics *metrics = mTheme->mTextMetrics.get();
 
     float uw = 0;
     if (mUnitsImage > 0) {
@@ -69,14 +70,14 @@ Vector2i TextBox::preferredSize(NVGcontext *ctx) const {
         float uh = size(1) * 0.4f;
         uw = w * uh / h;
     } else if (!mUnits.empty()) {
-        uw = nvgTextBounds(ctx, 0, 0, mUnits.c_str(), nullptr, nullptr);
+        uw = metrics->textBounds(ctx, "sans", fontSize(), mUnits);
     }
     float sw = 0;
     if (mSpinnable) {
         sw = 14.f;
     }
 
-    float ts = nvgTextBounds(ctx, 0, 0, mValue.c_str(), nullptr, nullptr);
+    float ts = metrics->textBounds(ctx, "sans", fontSize(), mValue);
     size(0) = size(1) + ts + uw + sw;
     return size;
 }
@@ -137,7 +138,7 @@ void TextBox::draw(NVGcontext* ctx) {
         nvgFill(ctx);
         unitWidth += 2;
     } else if (!mUnits.empty()) {
-        unitWidth = nvgTextBounds(ctx, 0, 0, mUnits.c_str(), nullptr, nullptr);
+        unitWidth = mTheme->mTextMetrics->textBounds(ctx, "sans", fontSize(), mUnits);
         nvgFillColor(ctx, Color(255, mEnabled ? 64 : 32));
         nvgTextAlign(ctx, NVG_ALIGN_RIGHT | NVG_ALIGN_MIDDLE);
         nvgText(ctx, mPos.x() + mSize.x() - xSpacing, drawPos.y(),
@@ -291,7 +292,7 @@ bool TextBox::mouseButtonEvent(const Vector2i &p, int button, bool down,
             mMouseDownPos = p;
             mMouseDownModifier = modifiers;
 
-            double time = glfwGetTime();
+            double time = ((Screen *) screen())->time();
             if (time - mLastClick < 0.25) {
                 /* Double-click: select all text */
                 mSelectionPos = 0;
@@ -310,10 +311,11 @@ bool TextBox::mouseButtonEvent(const Vector2i &p, int button, bool down,
                 mMouseDownPos = p;
                 mMouseDownModifier = modifiers;
 
-                double time = glfwGetTime();
+                double time = ((Screen *) screen())->time();
                 if (time - mLastClick < 0.25) {
                     /* Double-click: reset to default value */
                     mValue = mDefaultValue;
+                    invalidatePreferredSize();
                     if (mCallback)
                         mCallback(mValue);
 
@@ -383,6 +385,9 @@ bool TextBox::focusEvent(bool focused) {
             if (mCallback && !mCallback(mValue))
                 mValue = backup;
 
+            if (mValue != backup)
+                invalidatePreferredSize();
+
             mValidFormat = true;
             mCommitted = true;
             mCursorPos = -1;
@@ -518,8 +523,10 @@ bool TextBox::copySelection() {
         if (begin > end)
             std::swap(begin, end);
 
-        glfwSetClipboardString(sc->glfwWindow(),
-                               mValueTemp.substr(begin, end).c_str());
+        /* Headless screens have no access to the system clipboard */
+        if (sc->glfwWindow())
+            glfwSetClipboardString(sc->glfwWindow(),
+                                   mValueTemp.substr(begin, end).c_str());
         return true;
     }
 
@@ -528,6 +535,8 @@ bool TextBox::copySelection() {
 
 void TextBox::pasteFromClipboard() {
     Screen *sc = dynamic_cast<Screen *>(this->window()->parent());
+    if (!sc->glfwWindow())
+        return;
     const char* cbstr = glfwGetClipboardString(sc->glfwWindow());
     if (cbstr)
         mValueTemp.insert(mCursorPos, std::string(cbstr));
@@ -0,0 +1,104 @@
+/*
+    src/textmetrics.cpp -- Cached text measurements used by layout and
+    drawing code
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/textmetrics.h>
+#include <nanogui/opengl.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(nanogui)
+
+TextMetrics::Key::Key(const std::string &font, float size, float breakRowWidth,
+                      const std::string &text)
+    : font(&font), size(size), breakRowWidth(breakRowWidth), text(&text) {
+    hash = std::hash<std::string>()(text);
+    hash ^= std::hash<std::string>()(font) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(size) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    hash ^= std::hash<float>()(breakRowWidth) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+TextMetrics::TextMetrics(size_t capacity)
+    : mCapacity(std::max(capacity, (size_t) 1)), mHits(0), mMisses(0) { }
+
+float TextMetrics::textBounds(NVGcontext *ctx, const std::string &font, float size,
+                              const std::string &text, float *bounds) const {
+    const float *values = lookup(ctx, font, size, -1.f, text);
+    if (bounds)
+        std::copy(values + 1, values + 5, bounds);
+    return values[0];
+}
+
+void TextMetrics::textBoxBounds(NVGcontext *ctx, const std::string &font, float size,
+                                float breakRowWidth, const std::string &text, float *bounds) const {
+    const float *values = lookup(ctx, font, size, std::max(breakRowWidth, 0.f), text);
+    std::copy(values + 1, values + 5, bounds);
+}
+
+void TextMetrics::setCapacity(size_t capacity) {
+    mCapacity = std::max(capacity, (size_t) 1);
+    while (mEntries.size() > mCapacity) {
+        mIndex.erase(mEntries.back().key());
+        mEntries.pop_back();
+    }
+}
+
+void TextMetrics::clear() {
+    mEntries.clear();
+    mIndex.clear();
+}
+
+float TextMetrics::measure(NVGcontext *ctx, const std::string &font, float size,
+                           float breakRowWidth, const std::string &text,
+                           float *bounds) const {
+    /* Leave the font state of the caller untouched */
+    nvgSave(ctx);
+    nvgFontFace(ctx, font.c_str());
+    nvgFontSize(ctx, size);
+    nvgTextAlign(ctx, NVG_ALIGN_LEFT | NVG_ALIGN_TOP);
+    float advance;
+    if (breakRowWidth < 0) {
+        advance = nvgTextBounds(ctx, 0, 0, text.c_str(), nullptr, bounds);
+    } else {
+        nvgTextBoxBounds(ctx, 0, 0, breakRowWidth, text.c_str(), nullptr, bounds);
+        advance = bounds[2] - bounds[0];
+    }
+    nvgRestore(ctx);
+    return advance;
+}
+
+const float *TextMetrics::lookup(NVGcontext *ctx, const std::string &font, float size,
+                                 float breakRowWidth, const std::string &text) const {
+    /* Probe with a key referring to the caller's strings, and only copy
+       them into a new entry on a miss */
+    auto it = mIndex.find(Key(font, size, breakRowWidth, text));
+    if (it != mIndex.end()) {
+        /* Move the entry to the front of the LRU list */
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        mHits++;
+        return it->second->values;
+    }
+
+    mMisses++;
+    float values[5];
+    values[0] = measure(ctx, font, size, breakRowWidth, text, values + 1);
+
+    if (mEntries.size() >= mCapacity) {
+        mIndex.erase(mEntries.back().key());
+        mEntries.pop_back();
+    }
+    mEntries.push_front(Entry { font, text, size, breakRowWidth,
+                                { values[0], values[1], values[2], values[3], values[4] } });
+    Entry &entry = mEntries.front();
+    mIndex.insert(std::make_pair(entry.key(), mEntries.begin()));
+    return entry.values;
+}
+
+NAMESPACE_END(nanogui)
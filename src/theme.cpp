@@ -18,6 +18,8 @@
 NAMESPACE_BEGIN(nanogui)
 
 Theme::Theme(NVGcontext *ctx) {
+    mTextMetrics = new TextMetrics();
+
     mStandardFontSize                 = 16;
     mButtonFontSize                   = 20;
     mTextBoxFontSize                  = 20;
@@ -0,0 +1,193 @@
+/*
+    src/tiledimage.cpp -- Tiled, mipmapped image sources and the GPU
+    tile cache used by ImageView to display very large images
+
+    NanoGUI was developed by Wenzel Jakob <wenzel.jakob@epfl.ch>.
+    The widget drawing code is based on the NanoVG demo application
+    by Mikko Mononen.
+
+    All rights reserved. Use of this source code is governed by a
+    BSD-style license that can be found in the LICENSE.txt file.
+*/
+
+#include <nanogui/tiledimage.h>
+#include <nanogui/screen.h>
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+NAMESPACE_BEGIN(nanogui)
+
+int TiledImageSource::levelCount() const {
+    int levels = 1, extent = std::max(size().maxCoeff(), 1);
+    while (extent > tileSize()) {
+        extent = (extent + 1) / 2;
+        levels++;
+    }
+    return levels;
+}
+
+Vector2i TiledImageSource::levelSize(int level) const {
+    int round = (1 << level) - 1;
+    return Vector2i((size().x() + round) >> level, (size().y() + round) >> level);
+}
+
+Vector2i TiledImageSource::tileCount(int level) const {
+    int round = tileSize() - 1;
+    Vector2i size = levelSize(level);
+    return Vector2i((size.x() + round) / tileSize(), (size.y() + round) / tileSize());
+}
+
+TileCache::TileCache(TiledImageSource *source, int capacity, int threads)
+    : mSource(source), mTexture(0), mScreen(nullptr) {
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    mCapacity = std::max(1, std::min(capacity, (int) maxLayers));
+
+    int tileSize = source->tileSize();
+    glGenTextures(1, &mTexture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, tileSize, tileSize, mCapacity,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    for (int i = mCapacity - 1; i >= 0; --i)
+        mFreeLayers.push_back(i);
+
+    for (int i = 0; i < std::max(threads, 1); ++i)
+        mThreads.emplace_back([this] { run(); });
+}
+
+TileCache::~TileCache() {
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    for (auto &thread : mThreads)
+        thread.join();
+    glDeleteTextures(1, &mTexture);
+}
+
+void TileCache::request(const std::vector<std::pair<int, Vector2i>> &tiles) {
+    std::lock_guard<std::mutex> guard(mMutex);
+    mQueue.clear();
+    /* More tiles than fit into the cache would evict each other again and
+       again, so only the most important ones are considered */
+    size_t count = std::min(tiles.size(), (size_t) mCapacity);
+    std::unordered_set<uint64_t> queued;
+    for (size_t i = 0; i < count; ++i) {
+        const auto &tile = tiles[i];
+        uint64_t k = key(tile.first, tile.second);
+        if (mResident.count(k) || mInFlight.count(k) || mFailed.count(k) ||
+            !queued.insert(k).second)
+            continue;
+        mQueue.push_back(k);
+    }
+    mCondition.notify_all();
+}
+
+void TileCache::update() {
+    mFrame++;
+
+    std::vector<std::pair<uint64_t, std::vector<uint8_t>>> loaded;
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        loaded.swap(mLoaded);
+    }
+    if (loaded.empty())
+        return;
+
+    int tileSize = mSource->tileSize();
+    size_t uploaded = 0;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, mTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (const auto &tile : loaded) {
+        if (mFreeLayers.empty()) {
+            /* Evict the least recently used tile, unless the previous frame
+               still needed it (the new tile is then kept for a later frame) */
+            auto it = mResident.find(mLru.back());
+            if (it->second.lastUsed + 1 >= mFrame)
+                break;
+            mFreeLayers.push_back(it->second.layer);
+            mLru.pop_back();
+            mResident.erase(it);
+            mEvictionCount++;
+        }
+
+        assert(mResident.find(tile.first) == mResident.end());
+        int layer = mFreeLayers.back();
+        mFreeLayers.pop_back();
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, tileSize, tileSize, 1,
+                        GL_RGBA, GL_UNSIGNED_BYTE, tile.second.data());
+        mLru.push_front(tile.first);
+        mResident[tile.first] = Entry { layer, mFrame, mLru.begin() };
+        mUploadCount++;
+        uploaded++;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    /* Tiles that did not fit stay loaded (and in flight, so that they are
+       not requested again) until a layer can be freed */
+    std::lock_guard<std::mutex> guard(mMutex);
+    for (size_t i = 0; i < uploaded; ++i)
+        mInFlight.erase(loaded[i].first);
+    mLoaded.insert(mLoaded.begin(), std::make_move_iterator(loaded.begin() + uploaded),
+                   std::make_move_iterator(loaded.end()));
+}
+
+int TileCache::lookup(int level, const Vector2i &tile) {
+    auto it = mResident.find(key(level, tile));
+    if (it == mResident.end())
+        return -1;
+    Entry &entry = it->second;
+    entry.lastUsed = mFrame;
+    mLru.splice(mLru.begin(), mLru, entry.lru);
+    return entry.layer;
+}
+
+size_t TileCache::pendingCount() const {
+    std::lock_guard<std::mutex> guard(mMutex);
+    return mQueue.size() + mInFlight.size();
+}
+
+void TileCache::run() {
+    size_t tileSize = (size_t) mSource->tileSize();
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mCondition.wait(lock, [this] { return mStop || !mQueue.empty(); });
+        if (mStop)
+            break;
+        uint64_t k = mQueue.front();
+        mQueue.pop_front();
+        mInFlight.insert(k);
+        lock.unlock();
+
+        int level = (int) (k >> 56);
+        Vector2i tile((int) (k & 0xFFFFFFF), (int) ((k >> 28) & 0xFFFFFFF));
+        std::vector<uint8_t> rgba(tileSize * tileSize * 4, 0);
+        bool success;
+        try {
+            success = mSource->loadTile(level, tile, rgba.data());
+        } catch (const std::exception &) {
+            success = false;
+        }
+
+        lock.lock();
+        if (success) {
+            mLoaded.emplace_back(k, std::move(rgba));
+        } else {
+            mInFlight.erase(k);
+            mFailed.insert(k);
+        }
+        Screen *screen = mScreen;
+        if (screen && success)
+            screen->redraw();
+    }
+}
+
+NAMESPACE_END(nanogui)
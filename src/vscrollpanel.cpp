@@ -16,6 +16,7 @@
 #include <nanogui/theme.h>
 #include <nanogui/opengl.h>
 #include <nanogui/serializer/core.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(nanogui)
 
@@ -29,10 +30,22 @@ VScrollPanel::VScrollPanel(Widget *parent)
 
 
 //************ Styling ******************************/
+void VScrollPanel::setScroll(float scroll) {
+    if (mChildren.empty())
+        return;
+    float maxScroll = std::max(0.f, (float) (mChildPreferredHeight - mSize.y()));
+    scroll = std::max(0.f, std::min(maxScroll, scroll));
+    if (scroll == mScroll)
+        return;
+    mScroll = scroll;
+    //scrolling only moves the child, its layout stays valid
+    mChildren[0]->setPosition(Vector2i(0, (int) -mScroll));
+    markDirty();
+}
+
 void VScrollPanel::performLayout(NVGcontext *ctx) {
     //don't use layout on  this widget
     mLayout = nullptr;
-    Widget::performLayout(ctx);
 
     if (mChildren.empty())
         return;
@@ -45,11 +58,13 @@ void VScrollPanel::performLayout(NVGcontext *ctx) {
         if(parent()){//second, further confine to parent
             mSize.y() =  std::min(mSize.y(), parent()->height() - mPos.y());
         }
+        invalidateParentIndex();
     }
     Widget *child = mChildren[0];
-    mChildPreferredHeight = child->preferredSize(ctx).y();
-    //translate the child based on the current scroll shift
-    child->setPosition(Vector2i(0, -mScroll*(mChildPreferredHeight - mSize.y())));
+    mChildPreferredHeight = child->cachedPreferredSize(ctx).y();
+    //keep the scroll offset in pixels, clamped to the new content height
+    mScroll = std::max(0.f, std::min((float) std::max(0, mChildPreferredHeight - mSize.y()), mScroll));
+    child->setPosition(Vector2i(0, (int) -mScroll));
     child->setSize(Vector2i(mSize.x()-scroller_width, mChildPreferredHeight));
     child->performLayout(ctx);
 }
@@ -57,7 +72,7 @@ void VScrollPanel::performLayout(NVGcontext *ctx) {
 Vector2i VScrollPanel::preferredSize(NVGcontext *ctx) const {
     if (mChildren.empty())
         return Vector2i::Zero();
-    return mChildren[0]->preferredSize(ctx) + Vector2i(scroller_width, 0);
+    return mChildren[0]->cachedPreferredSize(ctx) + Vector2i(scroller_width, 0);
 }
 
 bool VScrollPanel::mouseDragEvent(const Vector2i &p, const Vector2i &rel,
@@ -68,8 +83,8 @@ bool VScrollPanel::mouseDragEvent(const Vector2i &p, const Vector2i &rel,
         float knob_height = height() *
             std::min(1.0f, height() / (float)mChildPreferredHeight);
 
-        mScroll = std::max((float) 0.0f, std::min((float) 1.0f,
-                     mScroll + rel.y() / (float)(mSize.y() - 2*scroller_end_padding - knob_height)));
+        setScroll(mScroll + rel.y() * (mChildPreferredHeight - mSize.y()) /
+                  (float)(mSize.y() - 2*scroller_end_padding - knob_height));
         return true;
     } else {
         return Widget::mouseDragEvent(p, rel, button, modifiers);
@@ -81,8 +96,8 @@ bool VScrollPanel::scrollEvent(const Vector2i &p , const Vector2f &rel) {
         float knob_height = height() *
             std::min(1.0f, height() / (float)mChildPreferredHeight);
 
-        mScroll = std::max((float) 0.0f, std::min((float) 1.0f,
-                     mScroll + rel.y() / (float)(mSize.y() - 2*scroller_end_padding - knob_height)));
+        setScroll(mScroll + rel.y() * (mChildPreferredHeight - mSize.y()) /
+                  (float)(mSize.y() - 2*scroller_end_padding - knob_height));
         return true;
     } else {
         return Widget::scrollEvent(p, rel);
@@ -92,21 +107,23 @@ bool VScrollPanel::scrollEvent(const Vector2i &p , const Vector2f &rel) {
 void VScrollPanel::draw(NVGcontext *ctx) {
     if (mChildren.empty())
         return;
+    //the layout is refreshed by the screen when the content or size change
     Widget *child = mChildren[0];
-    mChildPreferredHeight = child->preferredSize(ctx).y();
     float knob_height = height() *
         std::min(1.0f, height() / (float) mChildPreferredHeight);
+    float knob_pos = mChildPreferredHeight > mSize.y() ?
+        (mSize.y() - 2*scroller_end_padding - knob_height) * mScroll /
+        (float) (mChildPreferredHeight - mSize.y()) : 0.f;
 
     nvgSave(ctx);
     nvgTranslate(ctx, mPos.x(), mPos.y());
     nvgIntersectScissor(ctx, 0, 0, mSize.x(), mSize.y());
-    performLayout(ctx);
     if (child->visible()){
         child->draw(ctx);
     }
     nvgRestore(ctx);
     //don't draw the scroller if there's nothing to scroll
-    if(mChildren[0]->height() <= height())
+    if(child->height() <= height())
         return;
     //draw the scroller
     NVGpaint paint = nvgBoxGradient(ctx,
@@ -127,13 +144,13 @@ void VScrollPanel::draw(NVGcontext *ctx) {
     //draw the scroller knob
     paint = nvgBoxGradient(ctx,
         mPos.x() + mSize.x() - scroller_width - 1,
-        mPos.y() + scroller_end_padding + (mSize.y() - 2*scroller_end_padding - knob_height) * mScroll - 1,
+        mPos.y() + scroller_end_padding + knob_pos - 1,
         knob_width, knob_height,
         3, 4, Color(220, 100), Color(128, 100));
     nvgBeginPath(ctx);
     nvgRoundedRect(ctx,
                    mPos.x() + mSize.x() - scroller_width + 1,
-                   mPos.y() + scroller_end_padding + 1 + (mSize.y() - 2*scroller_end_padding - knob_height) * mScroll,
+                   mPos.y() + scroller_end_padding + 1 + knob_pos,
                    knob_width - 2,
                    knob_height - 2, 2);
     nvgFillPaint(ctx, paint);
@@ -144,13 +161,21 @@ void VScrollPanel::draw(NVGcontext *ctx) {
 void VScrollPanel::save(Serializer &s) const {
     Widget::save(s);
     s.set("childPreferredHeight", mChildPreferredHeight);
-    s.set("scroll", mScroll);
+    s.set("scrollOffset", mScroll);
 }
 
 bool VScrollPanel::load(Serializer &s) {
     if (!Widget::load(s)) return false;
     if (!s.get("childPreferredHeight", mChildPreferredHeight)) return false;
-    if (!s.get("scroll", mScroll)) return false;
+    auto keys = s.keys();
+    if (std::find(keys.begin(), keys.end(), "scrollOffset") != keys.end()) {
+        if (!s.get("scrollOffset", mScroll)) return false;
+    } else {
+        /* Older files store the scroll position as a fraction of the scrollable range */
+        float fraction;
+        if (!s.get("scroll", fraction)) return false;
+        mScroll = fraction * std::max(0, mChildPreferredHeight - mSize.y());
+    }
     return true;
 }
 
@@ -15,14 +15,29 @@
 #include <nanogui/window.h>
 #include <nanogui/opengl.h>
 #include <nanogui/screen.h>
+#include <nanogui/spatialgrid.h>
+#include <nanogui/profiler.h>
 #include <nanogui/serializer/core.h>
 
 NAMESPACE_BEGIN(nanogui)
 
+/* See Widget::setPreferredSizeCaching */
+static bool __nanogui_preferred_size_caching = true;
+
+/* Scissor rectangle (x0, y0, x1, y1 in screen coordinates) enclosing the
+   widget that is currently being drawn, and the number of widgets that were
+   culled against it during the current frame. Both are reset by
+   Screen::drawWidgets() */
+Vector4f __nanogui_clip_rect = Vector4f::Zero();
+size_t __nanogui_culled_widgets = 0;
+
 Widget::Widget(Widget *parent)
     : mParent(nullptr), mTheme(nullptr), mLayout(nullptr),
       mPos(Vector2i::Zero()), mSize(Vector2i::Zero()),
-      mFixedSize(Vector2i::Zero()), mVisible(true), mEnabled(true),
+      mFixedSize(Vector2i::Zero()), mSpatialIndex(nullptr),
+      mSpatialIndexValid(false), mPreferredSize(Vector2i::Zero()),
+      mPreferredSizeValid(false), mLayoutDirty(false), mLayoutPending(false),
+      mVisible(true), mEnabled(true),
       mFocused(false), mMouseFocus(false),
       mShowBorder(false), mBorderColor(Color(100,100,100,255)),
       mTooltip(""), mFontSize(-1.0f),
@@ -36,6 +51,7 @@ Widget::~Widget() {
         if (child)
             child->decRef();
     }
+    delete mSpatialIndex;
 }
 
 Widget* Widget::screen(){
@@ -61,6 +77,7 @@ void Widget::setTheme(Theme *theme) {
     if (mTheme.get() == theme)
         return;
     mTheme = theme;
+    invalidatePreferredSize();
     for (auto child : mChildren)
         child->setTheme(theme);
 }
@@ -76,12 +93,79 @@ Vector2i Widget::preferredSize(NVGcontext *ctx) const {
         return mSize;
 }
 
+Vector2i Widget::cachedPreferredSize(NVGcontext *ctx) const {
+    if (!__nanogui_preferred_size_caching)
+        return preferredSize(ctx);
+    if (!mPreferredSizeValid) {
+        mPreferredSize = preferredSize(ctx);
+        mPreferredSizeValid = true;
+    }
+    return mPreferredSize;
+}
+
+void Widget::setPreferredSizeCaching(bool enabled) {
+    __nanogui_preferred_size_caching = enabled;
+}
+
+bool Widget::preferredSizeCaching() {
+    return __nanogui_preferred_size_caching;
+}
+
+void Widget::invalidatePreferredSize() {
+    /* The change propagates up to the nearest widget whose size does not
+       depend on its contents: one with a fixed size or a top-level window */
+    Widget *root = nullptr;
+    for (Widget *widget = this; widget; widget = widget->mParent) {
+        widget->mPreferredSizeValid = false;
+        if (!root && (!widget->mParent || !widget->mParent->mParent ||
+                      (widget->mFixedSize.array() != 0).all()))
+            root = widget;
+    }
+    root->markLayoutDirty();
+}
+
+void Widget::markLayoutDirty() {
+    mLayoutDirty = true;
+
+    /* Flag the path to the root so that the layout pass can find this widget */
+    Widget *widget = this;
+    while (!widget->mLayoutPending) {
+        widget->mLayoutPending = true;
+        if (!widget->mParent) {
+            Screen *screen = dynamic_cast<Screen *>(widget);
+            if (screen)
+                screen->mRedraw = true;
+            break;
+        }
+        widget = widget->mParent;
+    }
+}
+
+void Widget::collectLayoutRoots(std::vector<Widget *> &roots) {
+    if (!mLayoutPending)
+        return;
+    if (mLayoutDirty && mParent) {
+        roots.push_back(this);
+        return;
+    }
+    for (auto child : mChildren)
+        child->collectLayoutRoots(roots);
+}
+
+void Widget::clearLayoutDirty() {
+    if (!mLayoutPending)
+        return;
+    mLayoutDirty = mLayoutPending = false;
+    for (auto child : mChildren)
+        child->clearLayoutDirty();
+}
+
 void Widget::performLayout(NVGcontext *ctx) {
     if (mLayout) {
         mLayout->performLayout(ctx, this);
     } else {
         for (auto c : mChildren) {
-            Vector2i pref = c->preferredSize(ctx), fix = c->fixedSize();
+            Vector2i pref = c->cachedPreferredSize(ctx), fix = c->fixedSize();
             c->setSize(Vector2i(
                 fix[0] ? fix[0] : pref[0],
                 fix[1] ? fix[1] : pref[1]
@@ -91,8 +175,27 @@ void Widget::performLayout(NVGcontext *ctx) {
     }
 }
 
+void Widget::setSpatialIndex(bool enabled) {
+    if (enabled == (mSpatialIndex != nullptr))
+        return;
+    delete mSpatialIndex;
+    mSpatialIndex = enabled ? new SpatialGrid() : nullptr;
+    mSpatialIndexValid = false;
+}
+
+const std::vector<Widget *> &Widget::hitCandidates(const Vector2i &p0, const Vector2i &p1) {
+    if (!mSpatialIndex)
+        return mChildren;
+    if (!mSpatialIndexValid) {
+        mSpatialIndex->build(mChildren);
+        mSpatialIndexValid = true;
+    }
+    return mSpatialIndex->query(p0, p1, mChildren);
+}
+
 Widget *Widget::findWidget(const Vector2i &p) {
-    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it) {
+    const std::vector<Widget *> &children = hitCandidates(p - mPos, p - mPos);
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
         Widget *child = *it;
         if (child->visible() && child->contains(p - mPos))
             return child->findWidget(p - mPos);
@@ -101,7 +204,8 @@ Widget *Widget::findWidget(const Vector2i &p) {
 }
 
 bool Widget::mouseButtonEvent(const Vector2i &p, int button, bool down, int modifiers) {
-    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it) {
+    const std::vector<Widget *> &children = hitCandidates(p - mPos, p - mPos);
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
         Widget *child = *it;
         if (child->visible() && child->contains(p - mPos) &&
             child->mouseButtonEvent(p - mPos, button, down, modifiers))
@@ -113,7 +217,8 @@ bool Widget::mouseButtonEvent(const Vector2i &p, int button, bool down, int modi
 }
 
 bool Widget::mouseMotionEvent(const Vector2i &p, const Vector2i &rel, int button, int modifiers) {
-    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it) {
+    const std::vector<Widget *> &children = hitCandidates(p - mPos, p - mPos - rel);
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
         Widget *child = *it;
         if (!child->visible())
             continue;
@@ -128,7 +233,8 @@ bool Widget::mouseMotionEvent(const Vector2i &p, const Vector2i &rel, int button
 }
 
 bool Widget::scrollEvent(const Vector2i &p, const Vector2f &rel) {
-    for (auto it = mChildren.rbegin(); it != mChildren.rend(); ++it) {
+    const std::vector<Widget *> &children = hitCandidates(p - mPos, p - mPos);
+    for (auto it = children.rbegin(); it != children.rend(); ++it) {
         Widget *child = *it;
         if (!child->visible())
             continue;
@@ -166,6 +272,15 @@ void Widget::addChild(int index, Widget * widget) {
     widget->incRef();
     widget->setParent(this);
     widget->setTheme(mTheme);
+    if (widget->mLayoutPending) {
+        /* The subtree was marked while detached: flag it again so that the
+           path to the new root is marked as well */
+        widget->clearLayoutDirty();
+        widget->markLayoutDirty();
+    }
+    mSpatialIndexValid = false;
+    invalidatePreferredSize();
+    markDirty();
 }
 
 void Widget::addChild(Widget * widget) {
@@ -175,12 +290,18 @@ void Widget::addChild(Widget * widget) {
 void Widget::removeChild(const Widget *widget) {
     mChildren.erase(std::remove(mChildren.begin(), mChildren.end(), widget), mChildren.end());
     widget->decRef();
+    mSpatialIndexValid = false;
+    invalidatePreferredSize();
+    markDirty();
 }
 
 void Widget::removeChild(int index) {
     Widget *widget = mChildren[index];
     mChildren.erase(mChildren.begin() + index);
     widget->decRef();
+    mSpatialIndexValid = false;
+    invalidatePreferredSize();
+    markDirty();
 }
 
 void Widget::removeAllChildren() {
@@ -216,6 +337,15 @@ void Widget::requestFocus() {
     ((Screen *) widget)->updateFocus(this);
 }
 
+void Widget::markDirty() {
+    Widget *widget = this;
+    while (widget->parent())
+        widget = widget->parent();
+    Screen *screen = dynamic_cast<Screen *>(widget);
+    if (screen)
+        screen->mRedraw = true;
+}
+
 void Widget::draw(NVGcontext *ctx) {
      if (mShowBorder == true) {
         nvgStrokeWidth(ctx, 1.0f);
@@ -230,14 +360,41 @@ void Widget::draw(NVGcontext *ctx) {
 
     nvgSave(ctx);
     nvgTranslate(ctx, mPos.x(), mPos.y());
+
+    /* Track the scissor rectangle unless a widget applied a rotation or skew
+       transform. Children of the root widget (windows and popups) update
+       their placement while drawing and are never culled. */
+    float xform[6];
+    nvgCurrentTransform(ctx, xform);
+    bool axisAligned = xform[1] == 0 && xform[2] == 0;
+    const Vector4f clip = __nanogui_clip_rect;
+
     for (auto child : mChildren) {
-        if (child->visible()) {
-            nvgSave(ctx);
-            nvgIntersectScissor(ctx, child->mPos.x(), child->mPos.y(), child->mSize.x(), child->mSize.y());
-            child->draw(ctx);
-            nvgRestore(ctx);
+        if (!child->visible())
+            continue;
+
+        if (axisAligned) {
+            Vector4f childClip(
+                std::max(clip[0], xform[0] * child->mPos.x() + xform[4]),
+                std::max(clip[1], xform[3] * child->mPos.y() + xform[5]),
+                std::min(clip[2], xform[0] * (child->mPos.x() + child->mSize.x()) + xform[4]),
+                std::min(clip[3], xform[3] * (child->mPos.y() + child->mSize.y()) + xform[5]));
+
+            /* Skip the child and its subtree if it lies outside of the current scissor rectangle */
+            if (mParent && (childClip[0] >= childClip[2] || childClip[1] >= childClip[3])) {
+                __nanogui_culled_widgets++;
+                continue;
+            }
+            __nanogui_clip_rect = childClip;
         }
+
+        NANOGUI_PROFILE_WIDGET("draw", child);
+        nvgSave(ctx);
+        nvgIntersectScissor(ctx, child->mPos.x(), child->mPos.y(), child->mSize.x(), child->mSize.y());
+        child->draw(ctx);
+        nvgRestore(ctx);
     }
+    __nanogui_clip_rect = clip;
     nvgRestore(ctx);
 }
 
@@ -33,10 +33,8 @@ Vector2i Window::preferredSize(NVGcontext *ctx) const {
     if (mButtonPanel)
         mButtonPanel->setVisible(true);
 
-    nvgFontSize(ctx, 18.0f);
-    nvgFontFace(ctx, "sans-bold");
     float bounds[4];
-    nvgTextBounds(ctx, 0, 0, mTitle.c_str(), nullptr, bounds);
+    mTheme->mTextMetrics->textBounds(ctx, "sans-bold", 18.0f, mTitle, bounds);
 
     return result.cwiseMax(Vector2i(
         bounds[2]-bounds[0] + 20, bounds[3]-bounds[1]
@@ -65,7 +63,7 @@ void Window::performLayout(NVGcontext *ctx) {
         }
         mButtonPanel->setVisible(true);
         mButtonPanel->setSize(Vector2i(width(), 22));
-        mButtonPanel->setPosition(Vector2i(width() - (mButtonPanel->preferredSize(ctx).x() + 5), 3));
+        mButtonPanel->setPosition(Vector2i(width() - (mButtonPanel->cachedPreferredSize(ctx).x() + 5), 3));
         mButtonPanel->performLayout(ctx);
     }
 }
@@ -169,6 +167,7 @@ bool Window::mouseDragEvent(const Vector2i &, const Vector2i &rel,
         mPos += rel;
         mPos = mPos.cwiseMax(Vector2i::Zero());
         mPos = mPos.cwiseMin(parent()->size() - mSize);
+        invalidateParentIndex();
         return true;
     }
     return false;